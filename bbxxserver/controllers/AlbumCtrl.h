@@ -2,7 +2,7 @@
 
 #include <drogon/HttpController.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
 
 class AlbumCtrl : public drogon::HttpController<AlbumCtrl>
 {
@@ -15,9 +15,7 @@ public:
 
     void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
-
-        std::optional<server::Album> album = storage.get_optional<server::Album>(id);
+        std::optional<server::Album> album = server::StoragePool::get().get_optional<server::Album>(id);
 
         if (!album)
         {
@@ -42,8 +40,7 @@ public:
 
     void get_all(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
     {
-        server::Storage storage = server::init_storage();
-        std::vector<server::Album> albums = storage.get_all<server::Album>();
+        std::vector<server::Album> albums = server::StoragePool::get().get_all<server::Album>();
         
         Json::Value albums_json { Json::arrayValue };
         for(const server::Album& album : albums)
@@ -111,7 +108,7 @@ public:
         
         try
         {
-            server::Storage storage = server::init_storage();
+            server::Storage& storage = server::StoragePool::get().storage();
             uint64_t id = storage.insert(album);
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
@@ -2,7 +2,7 @@
 
 #include <drogon/HttpController.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
 
 class ArtistCtrl : public drogon::HttpController<ArtistCtrl>
 {
@@ -15,7 +15,7 @@ public:
 
     void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
+        server::Storage& storage = server::StoragePool::get().storage();
 
         try
         {
@@ -39,8 +39,7 @@ public:
 
     void get_all(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
     {
-        server::Storage storage = server::init_storage();
-        std::vector<server::Artist> artists = storage.get_all<server::Artist>();
+        std::vector<server::Artist> artists = server::StoragePool::get().get_all<server::Artist>();
         
         Json::Value artists_json { Json::arrayValue };
         
@@ -85,7 +84,7 @@ public:
         
         try
         {
-            auto storage = server::init_storage();
+            server::Storage& storage = server::StoragePool::get().storage();
             int id = storage.insert(artist);
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
@@ -3,7 +3,9 @@
 #include <drogon/HttpController.h>
 #include <bcrypt/BCrypt.hpp>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
+#include "../models/session_cache.h"
+#include "../utils/worker_pool.h"
 
 class AuthCtrl : public drogon::HttpController<AuthCtrl>
 {
@@ -11,7 +13,7 @@ public:
     METHOD_LIST_BEGIN
         ADD_METHOD_TO(AuthCtrl::registerr, "/register", drogon::Post, "ApiFilter");
         ADD_METHOD_TO(AuthCtrl::login, "/login", drogon::Post, "ApiFilter");
-        ADD_METHOD_TO(AuthCtrl::logout, "/logout", drogon::Post, "ApiFilter");
+        ADD_METHOD_TO(AuthCtrl::logout, "/logout", drogon::Post, "ApiFilter", "AuthFilter");
     METHOD_LIST_END
 
     void registerr(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
@@ -46,7 +48,7 @@ public:
         std::string username = (*json_ptr)["username"].asString();
         std::string password = (*json_ptr)["password"].asString();
 
-        server::Storage storage = server::init_storage();
+        server::Storage& storage = server::StoragePool::get().storage();
         std::vector<server::User> users = storage.get_all<server::User>(
             sqlite_orm::where(sqlite_orm::c(&server::User::username) == username)
         );
@@ -60,28 +62,32 @@ public:
             return;
         }
         
-        server::User user;
-        user.username = username;
-        user.password_hash = BCrypt::generateHash(password);
-
-        try
+        // bcrypt is deliberately slow, so hash (and insert) off of the event loop. see worker_pool.h
+        server::WorkerPool::get().respond_async([username = std::move(username), password = std::move(password)]()
         {
-            int id = storage.insert(user);
+            server::User user;
+            user.username = username;
+            user.password_hash = BCrypt::generateHash(password);
 
-            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("new user '" + user.username + "' created :)");
+            try
+            {
+                int id = server::StoragePool::get().storage().insert(user);
 
-            callback(resp);
-        }
-        catch(const std::exception& e)
-        {
-            LOG_ERROR << "db error: " << e.what();
-            
-            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("failed to add new user to db!");
-            
-            callback(resp);
-        }
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("new user '" + user.username + "' created :)");
+
+                return resp;
+            }
+            catch(const std::exception& e)
+            {
+                LOG_ERROR << "db error: " << e.what();
+                
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("failed to add new user to db!");
+                
+                return resp;
+            }
+        }, std::move(callback));
     }
 
     void login(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
@@ -116,7 +122,7 @@ public:
         std::string username = (*json_ptr)["username"].asString();
         std::string password = (*json_ptr)["password"].asString();
         
-        server::Storage storage = server::init_storage();
+        server::Storage& storage = server::StoragePool::get().storage();
         std::vector<server::User> users = storage.get_all<server::User>(
             sqlite_orm::where(sqlite_orm::c(&server::User::username) == username)
         );
@@ -130,43 +136,68 @@ public:
             return;
         }
         
-        const server::User& user = users[0];
-        
-        if( !BCrypt::validatePassword(password, user.password_hash) )
+        // bcrypt is deliberately slow, so validate (and create the session) off of the event loop. see worker_pool.h
+        server::WorkerPool::get().respond_async([user = std::move(users[0]), password = std::move(password)]()
         {
-            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k404NotFound, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("invalid username/password!");
+            if( !BCrypt::validatePassword(password, user.password_hash) )
+            {
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k404NotFound, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("invalid username/password!");
+
+                return resp;
+            }
+            
+            server::UserSession user_session;
+            user_session.uuid = drogon::utils::getUuid();
+            user_session.USER_ID = user.id;
+            user_session.expire_time = trantor::Date::now().after(60 * 60 * 24).secondsSinceEpoch(); // valid for 24 hrs
+            
+            try
+            {
+                server::StoragePool::get().storage().replace(user_session); // we dont care about id; user_session primary key is uuid (so we need replace instead of insert)
+                server::SessionCache::get().insert(user_session);
+
+                Json::Value json;
+                json["uuid"] = user_session.uuid;
+
+                return drogon::HttpResponse::newHttpJsonResponse(json);
+            }
+            catch(const std::exception& e)
+            {
+                LOG_ERROR << "db error: " << e.what();
+                
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("failed to add new user_session to db!");
+                
+                return resp;
+            }
+        }, std::move(callback));
+    }
+
+    void logout(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
+    {
+        // AuthFilter has already made sure this is a valid, unexpired session
+        std::string uuid = req->attributes()->get<std::string>("SESSION_UUID");
+
+        server::SessionCache::get().remove(uuid);
 
-            callback(resp);
-            return;
-        }
-        
-        server::UserSession user_session;
-        user_session.uuid = drogon::utils::getUuid();
-        user_session.USER_ID = user.id;
-        user_session.expire_time = trantor::Date::now().after(60 * 60 * 24).secondsSinceEpoch(); // valid for 24 hrs
-        
         try
         {
-            storage.replace(user_session); // we dont care about id; user_session primary key is uuid (so we need replace instead of insert)
+            server::StoragePool::get().storage().remove<server::UserSession>(uuid);
 
-            Json::Value json;
-            json["uuid"] = user_session.uuid;
+            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k200OK, drogon::ContentType::CT_TEXT_HTML);
+            resp->setBody("logged out :)");
 
-            callback(drogon::HttpResponse::newHttpJsonResponse(json));
+            callback(resp);
         }
         catch(const std::exception& e)
         {
             LOG_ERROR << "db error: " << e.what();
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("failed to add new user_session to db!");
+            resp->setBody("failed to remove user_session from db!");
             
             callback(resp);
         }
     }
-
-    void logout(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
-    {
-    }
 }; // AuthCtrl
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 #include <drogon/HttpController.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
 
 class ChartCtrl : public drogon::HttpController<ChartCtrl>
 {
@@ -15,9 +15,7 @@ public:
 
     void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
-        
-        std::optional<server::Chart> chart = storage.get_optional<server::Chart>(id);
+        std::optional<server::Chart> chart = server::StoragePool::get().get_optional<server::Chart>(id);
         
         if(!chart)
         {
@@ -38,8 +36,7 @@ public:
 
     void get_all(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
     {
-        server::Storage storage = server::init_storage();
-        std::vector<server::Chart> charts = storage.get_all<server::Chart>();
+        std::vector<server::Chart> charts = server::StoragePool::get().get_all<server::Chart>();
         
         Json::Value charts_json { Json::arrayValue };
         for(const server::Chart& chart : charts)
@@ -99,7 +96,7 @@ public:
 
         try
         {
-            server::Storage storage = server::init_storage();
+            server::Storage& storage = server::StoragePool::get().storage();
             uint64_t id = storage.insert(chart);
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
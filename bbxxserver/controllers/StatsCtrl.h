@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+    StatsCtrl reports bbxxserver's internal counters, e.g. StoragePool's connection hits/misses, the size of
+    FingerprintIndex and SessionCache, and how backed up WorkerPool is
+*/
+
+#include <drogon/HttpController.h>
+
+#include "../models/storage_pool.h"
+#include "../models/fingerprint_index.h"
+#include "../models/session_cache.h"
+#include "../utils/worker_pool.h"
+
+class StatsCtrl : public drogon::HttpController<StatsCtrl>
+{
+public:
+    METHOD_LIST_BEGIN
+        ADD_METHOD_TO(StatsCtrl::get, "/stats", drogon::Get, "ApiFilter");
+    METHOD_LIST_END
+
+    void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
+    {
+        Json::Value json;
+        json["storage_pool"] = server::StoragePool::get().stats();
+        json["fingerprint_index"] = server::FingerprintIndex::get().stats();
+        json["session_cache"] = server::SessionCache::get().stats();
+        json["worker_pool"] = server::WorkerPool::get().stats();
+
+        callback(drogon::HttpResponse::newHttpJsonResponse(json));
+    }
+}; // StatsCtrl
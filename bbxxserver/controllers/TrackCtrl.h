@@ -1,12 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
-#include <sstream>
-#include <unordered_set>
 
 #include <drogon/HttpController.h>
+#include <chromaprint.h>
+#include <miniaudio.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
+#include "../models/fingerprint_index.h"
+#include "../utils/worker_pool.h"
 
 class TrackCtrl : public drogon::HttpController<TrackCtrl>
 {
@@ -21,9 +25,7 @@ public:
 
     void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
-        
-        std::optional<server::Track> track = storage.get_optional<server::Track>(id);
+        std::optional<server::Track> track = server::StoragePool::get().get_optional<server::Track>(id);
         
         if(!track)
         {
@@ -45,8 +47,7 @@ public:
 
     void get_all(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
     {
-        server::Storage storage = server::init_storage();
-        std::vector<server::Track> tracks = storage.get_all<server::Track>();
+        std::vector<server::Track> tracks = server::StoragePool::get().get_all<server::Track>();
         
         Json::Value tracks_json { Json::arrayValue };
         for(const server::Track& track : tracks)
@@ -101,7 +102,7 @@ public:
 
         try
         {
-            server::Storage storage = server::init_storage();
+            server::Storage& storage = server::StoragePool::get().storage();
             uint64_t id = storage.insert(track);
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
@@ -121,53 +122,75 @@ public:
     }
     
     // generates the raw fingerprint of a drogon::HttpFile
+    // the upload is decoded straight out of its multipart buffer with miniaudio and fed to chromaprint, which
+    // gives the same hashes `fpcalc -raw` would (including fpcalc's default of only fingerprinting the first 120s)
     static std::optional<std::vector<uint32_t>> generate_raw_fingerprint(const drogon::HttpFile& file)
     {
-        // save file to disk temporarily
-        std::string uuid = drogon::utils::getUuid();
-        std::string temp_file_name = uuid + ".";
-        temp_file_name.append(file.getFileExtension());
-        
-        std::filesystem::path upload_dir = drogon::app().getUploadPath();
-        std::filesystem::path full_path = upload_dir / temp_file_name;
-        
-        if( file.saveAs(temp_file_name) != 0 )
+        static constexpr int max_length_in_seconds = 120;
+        static constexpr ma_uint64 chunk_size_in_frames = 4096;
+
+        // decode as s16, which is what chromaprint expects. channels and sample rate are left as-is since
+        // chromaprint downmixes and resamples internally
+        ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_s16, 0, 0);
+        ma_decoder decoder;
+        if( ma_decoder_init_memory(file.fileData(), file.fileLength(), &decoder_config, &decoder) != MA_SUCCESS )
         {
-            printf("[TrackCtrl::generate_raw_fingerprint] failed to save '%s'!", full_path.c_str());
+            printf("[TrackCtrl::generate_raw_fingerprint] miniaudio could not decode '%s'!", file.getFileName().c_str());
             return std::nullopt;
         }
+        std::unique_ptr<ma_decoder, decltype(&ma_decoder_uninit)> decoder_guard(&decoder, ma_decoder_uninit);
 
-        // run fpcalc
-        std::string command = "fpcalc -raw -plain \"" + full_path.string() + "\" 2>&1";
+        const ma_uint32 channels = decoder.outputChannels;
+        const ma_uint32 sample_rate = decoder.outputSampleRate;
 
-        std::array<char, 128> buffer;
-        std::string result;
-        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-        if( !pipe )
+        std::unique_ptr<ChromaprintContext, decltype(&chromaprint_free)> ctx(chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT), chromaprint_free);
+        if( !ctx || !chromaprint_start(ctx.get(), sample_rate, channels) )
         {
-            printf("[TrackCtrl::generate_raw_fingerprint] popen() failed!");
+            printf("[TrackCtrl::generate_raw_fingerprint] chromaprint_start() failed!");
             return std::nullopt;
         }
-        
-        while( fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr ) result += buffer.data();
-        if( result.substr(0, 5) == "ERROR" )
+
+        std::vector<int16_t> chunk(chunk_size_in_frames * channels);
+        ma_uint64 frames_remaining = static_cast<ma_uint64>(max_length_in_seconds) * sample_rate;
+        while( frames_remaining > 0 )
+        {
+            ma_uint64 frames_read = 0;
+            ma_result result = ma_decoder_read_pcm_frames(&decoder, chunk.data(), std::min(chunk_size_in_frames, frames_remaining), &frames_read);
+            if( frames_read == 0 ) break;
+
+            if( !chromaprint_feed(ctx.get(), chunk.data(), static_cast<int>(frames_read * channels)) )
+            {
+                printf("[TrackCtrl::generate_raw_fingerprint] chromaprint_feed() failed!");
+                return std::nullopt;
+            }
+
+            frames_remaining -= frames_read;
+            if( result != MA_SUCCESS ) break; // MA_AT_END
+        }
+
+        if( !chromaprint_finish(ctx.get()) )
         {
-            printf("[TrackCtrl::generate_raw_fingerprint] fpcalc gave an error:\n%s", result.c_str());
+            printf("[TrackCtrl::generate_raw_fingerprint] chromaprint_finish() failed!");
             return std::nullopt;
         }
 
-        // remove file from disk
-        if( std::filesystem::exists(full_path) ) std::filesystem::remove(full_path);
-        
-        // parse output into vector
-        std::vector<uint32_t> raw_fingerprint;
-        std::istringstream stream(result);
-        std::string token;
-        while( std::getline(stream, token, ',') )
+        uint32_t* raw_fingerprint_data = nullptr;
+        int raw_fingerprint_size = 0;
+        if( !chromaprint_get_raw_fingerprint(ctx.get(), &raw_fingerprint_data, &raw_fingerprint_size) )
         {
-            raw_fingerprint.push_back( static_cast<uint32_t>(std::stoul(token)) );
+            printf("[TrackCtrl::generate_raw_fingerprint] chromaprint_get_raw_fingerprint() failed!");
+            return std::nullopt;
         }
-        
+
+        std::vector<uint32_t> raw_fingerprint(raw_fingerprint_data, raw_fingerprint_data + raw_fingerprint_size);
+        chromaprint_dealloc(raw_fingerprint_data);
+
+        if( raw_fingerprint.empty() )
+        {
+            printf("[TrackCtrl::generate_raw_fingerprint] '%s' is too short to fingerprint!", file.getFileName().c_str());
+            return std::nullopt;
+        }
+
         return raw_fingerprint;
     }
     
@@ -198,10 +221,8 @@ public:
 
     void fingerprint(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
-
         // find track
-        std::optional<server::Track> track = storage.get_optional<server::Track>(id);
+        std::optional<server::Track> track = server::StoragePool::get().get_optional<server::Track>(id);
         if(!track)
         {
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k404NotFound, drogon::ContentType::CT_TEXT_HTML);
@@ -222,39 +243,29 @@ public:
             return;
         }
         
-        // generate raw fingerprint!
-        std::optional<std::vector<uint32_t>> raw_fingerprint = TrackCtrl::generate_raw_fingerprint(file.value());
-        if( !raw_fingerprint )
+        // fingerprinting is CPU-heavy, so it (and the db update) happens off of the event loop. see worker_pool.h
+        server::WorkerPool::get().respond_async([track = std::move(track.value()), file = std::move(file.value())]() mutable
         {
-            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("failed to fingerprint '" + track->title + "' ... (did you upload the right file?)");
-
-            callback(resp);
-            return;
-        }
-
-        // update db
-        track->raw_fingerprint = raw_fingerprint.value();
-        storage.update(*track);
-
-        drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k200OK, drogon::ContentType::CT_TEXT_HTML);
-        resp->setBody("'" + track->title + "' fingerprinted!");
-
-        callback(resp);
-        return;
-    }
-
-    // returns the number shared hashes between two raw fingerprints
-    static int compare_fingerprints(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
-    {
-        if( a.empty() || b.empty() ) return 0;
-
-        std::unordered_set<uint32_t> a_set(a.begin(), a.end());
-        
-        int matches = 0;
-        for( uint32_t hash : b ) if( a_set.contains(hash) ) matches++;
-        
-        return matches;
+            // generate raw fingerprint!
+            std::optional<std::vector<uint32_t>> raw_fingerprint = TrackCtrl::generate_raw_fingerprint(file);
+            if( !raw_fingerprint )
+            {
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("failed to fingerprint '" + track.title + "' ... (did you upload the right file?)");
+
+                return resp;
+            }
+
+            // update db
+            track.raw_fingerprint = raw_fingerprint.value();
+            server::StoragePool::get().storage().update(track);
+            server::FingerprintIndex::get().insert(track.id, track.title, track.raw_fingerprint.value());
+
+            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k200OK, drogon::ContentType::CT_TEXT_HTML);
+            resp->setBody("'" + track.title + "' fingerprinted!");
+
+            return resp;
+        }, std::move(callback));
     }
 
     void find_fingerprint(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
@@ -270,46 +281,46 @@ public:
             return;
         }
 
-        // generate raw fingerprint from file
-        std::optional<std::vector<uint32_t>> file_raw_fingerprint = generate_raw_fingerprint(file.value());
-        if( !file_raw_fingerprint )
-        {
-            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
-            resp->setBody("failed to fingerprint '" + file->getFileName() + "' ... (did you upload the right file?)");
-
-            callback(resp);
-            return;
-        }
-
-        // grab all tracks and compare fingerprints
-        server::Storage storage = server::init_storage();
-        std::vector<server::Track> tracks = storage.get_all<server::Track>();
-
-        Json::Value results(Json::arrayValue);
-        int file_hash_count = file_raw_fingerprint->size();
-
-        for( const server::Track& track : tracks )
+        server::WorkerPool::get().respond_async([file = std::move(file.value())]()
         {
-            if( !track.fingerprinted() ) continue;
-
-            int matches = compare_fingerprints(track.raw_fingerprint.value(), file_raw_fingerprint.value());
-            double confidence = static_cast<double>(matches) / file_hash_count;
-
-            //if( confidence < 0.05 ) continue;
-
-            Json::Value result;
-            result["track_id"] = track.id;
-            result["title"] = track.title;
-            result["matches"] = matches;
-            result["total"] = file_hash_count;
-            result["confidence"] = confidence;
-
-            results.append(result);
-        }
-
-        Json::Value json;
-        json["results"] = results;
-
-        callback(drogon::HttpResponse::newHttpJsonResponse(json));
+            // generate raw fingerprint from file
+            std::optional<std::vector<uint32_t>> file_raw_fingerprint = generate_raw_fingerprint(file);
+            if( !file_raw_fingerprint )
+            {
+                drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::HttpStatusCode::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("failed to fingerprint '" + file.getFileName() + "' ... (did you upload the right file?)");
+
+                return resp;
+            }
+
+            // look up candidates in the inverted index (see fingerprint_index.h)
+            std::chrono::steady_clock::time_point query_start = std::chrono::steady_clock::now();
+            std::vector<server::FingerprintIndex::Match> matches = server::FingerprintIndex::get().query(file_raw_fingerprint.value());
+            std::chrono::microseconds query_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - query_start);
+
+            Json::Value results(Json::arrayValue);
+            int file_hash_count = file_raw_fingerprint->size();
+
+            for( const server::FingerprintIndex::Match& match : matches )
+            {
+                double confidence = static_cast<double>(match.matches) / file_hash_count;
+
+                Json::Value result;
+                result["track_id"] = match.TRACK_ID;
+                result["title"] = match.title;
+                result["matches"] = match.matches;
+                result["total"] = file_hash_count;
+                result["confidence"] = confidence;
+                result["alignment"] = match.alignment;
+
+                results.append(result);
+            }
+
+            Json::Value json;
+            json["results"] = results;
+            json["query_time_us"] = static_cast<int64_t>(query_time.count());
+
+            return drogon::HttpResponse::newHttpJsonResponse(json);
+        }, std::move(callback));
     }
 }; // TrackCtrl
\ No newline at end of file
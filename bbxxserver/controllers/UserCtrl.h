@@ -2,7 +2,7 @@
 
 #include <drogon/HttpController.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
 
 class UserCtrl : public drogon::HttpController<UserCtrl>
 {
@@ -15,9 +15,7 @@ public:
 
     void get(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback, int id)
     {
-        server::Storage storage = server::init_storage();
-        
-        std::optional<server::User> user = storage.get_optional<server::User>(id);
+        std::optional<server::User> user = server::StoragePool::get().get_optional<server::User>(id);
         
         if(!user)
         {
@@ -39,8 +37,7 @@ public:
 
     void get_all(const drogon::HttpRequestPtr &req, std::function<void(const drogon::HttpResponsePtr &)> &&callback)
     {
-        server::Storage storage = server::init_storage();
-        std::vector<server::User> users = storage.get_all<server::User>();
+        std::vector<server::User> users = server::StoragePool::get().get_all<server::User>();
         
         Json::Value users_json { Json::arrayValue };
         for(const server::User& user : users)
@@ -96,7 +93,7 @@ public:
 
         try
         {
-            server::Storage storage = server::init_storage();
+            server::Storage& storage = server::StoragePool::get().storage();
             uint64_t id = storage.insert(user);
             
             drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k201Created, drogon::ContentType::CT_TEXT_HTML);
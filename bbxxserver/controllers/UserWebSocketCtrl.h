@@ -6,7 +6,7 @@
 
 #include <drogon/WebSocketController.h>
 
-#include "../models/storage.h"
+#include "../models/storage_pool.h"
 
 namespace server
 {
@@ -85,9 +85,8 @@ public:
     {
         uint64_t USER_ID = req->attributes()->get<uint64_t>("USER_ID");
 
-        server::Storage storage = server::init_storage();
-        std::unique_ptr<server::User> user_ptr = storage.get_pointer<server::User>(USER_ID);
-        if( !user_ptr ) // this should never happen thanks to AuthFilter!
+        std::optional<server::User> user = server::StoragePool::get().get_optional<server::User>(USER_ID);
+        if( !user ) // this should never happen thanks to AuthFilter!
         {
             LOG_ERROR << "[UserWebSocketCtrl::handleNewConnection] attempted to handle new web socket connection for user with id (" + std::to_string(USER_ID) + "), but no user exists! closing connection ...";
             wsConnPtr->forceClose();
@@ -96,7 +95,7 @@ public:
 
         std::shared_ptr<server::UserWebSocketCtx> ctx = std::make_shared<server::UserWebSocketCtx>();
         ctx->USER_ID = USER_ID;
-        ctx->username = user_ptr->username;
+        ctx->username = user->username;
         wsConnPtr->setContext(ctx);
         
         server::UserLobby& user_lobby = server::UserLobby::get();
@@ -3,6 +3,7 @@
 #include "AuthCtrl.h"
 #include "ChartCtrl.h"
 #include "HomeViewCtrl.h"
+#include "StatsCtrl.h"
 #include "TrackCtrl.h"
 #include "UserCtrl.h"
 #include "UserWebSocketCtrl.h"
\ No newline at end of file
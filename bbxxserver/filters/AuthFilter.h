@@ -8,7 +8,7 @@
 
 #include <drogon/HttpFilter.h>
 
-#include "../models/storage.h"
+#include "../models/session_cache.h"
 
 struct AuthFilter : public drogon::HttpFilter<AuthFilter>
 {
@@ -29,17 +29,16 @@ struct AuthFilter : public drogon::HttpFilter<AuthFilter>
         {
             std::string uuid = auth_header.substr(7);
             
-            server::Storage storage = server::init_storage();
-            std::unique_ptr<server::UserSession> user_session_ptr = storage.get_pointer<server::UserSession>(uuid);
+            std::optional<server::UserSession> user_session = server::SessionCache::get().find(uuid); // see session_cache.h
             
-            if( !user_session_ptr )
+            if( !user_session )
             {
                 drogon::HttpResponsePtr res = drogon::HttpResponse::newHttpResponse(drogon::k401Unauthorized, drogon::ContentType::CT_TEXT_HTML);
                 res->setBody("invalid uuid!");
                 fcb(res);
                 return;
             }
-            if( user_session_ptr->expired(trantor::Date::now().secondsSinceEpoch()) )
+            if( user_session->expired(trantor::Date::now().secondsSinceEpoch()) )
             {
                 drogon::HttpResponsePtr res = drogon::HttpResponse::newHttpResponse(drogon::k403Forbidden, drogon::ContentType::CT_TEXT_HTML);
                 res->setBody("uuid is expired!");
@@ -47,7 +46,8 @@ struct AuthFilter : public drogon::HttpFilter<AuthFilter>
                 return;
             }
             
-            req->attributes()->insert("USER_ID", user_session_ptr->USER_ID);
+            req->attributes()->insert("USER_ID", user_session->USER_ID);
+            req->attributes()->insert("SESSION_UUID", user_session->uuid);
 
             // passed!
             fccb();
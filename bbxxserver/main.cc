@@ -1,12 +1,16 @@
 #include <drogon/drogon.h>
 
 #include "models/storage.h"
+#include "models/fingerprint_index.h"
+#include "models/session_cache.h"
 
 int main()
 {
     // populate db with some entires
     server::Storage storage = server::init_storage();
     storage.sync_schema();
+    // WAL lets StoragePool's per-thread connections read while another one is writing
+    storage.pragma.journal_mode(sqlite_orm::journal_mode::WAL);
     if( storage.count<server::Artist>() == 0 )
     {
         // artists
@@ -45,6 +49,13 @@ int main()
         */
     }
 
+    // load every fingerprinted track into memory for /tracks/fingerprint
+    server::FingerprintIndex::get().build(storage);
+
+    // load user sessions into memory for AuthFilter, and sweep out expired ones every minute
+    server::SessionCache::get().load(storage, trantor::Date::now().secondsSinceEpoch());
+    drogon::app().getLoop()->runEvery(60.0, []() { server::SessionCache::get().sweep(trantor::Date::now().secondsSinceEpoch()); });
+
     // increase max body size for big audio file uploads
     drogon::app().setClientMaxBodySize(20 * 1024*1024); // 20mb
 
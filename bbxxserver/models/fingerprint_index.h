@@ -0,0 +1,177 @@
+#pragma once
+
+/*
+    FingerprintIndex is an in-memory inverted index of every fingerprinted Track's raw chromaprint hashes
+
+    each hash maps to a posting list of (TRACK_ID, offset), where offset is the index of that hash within
+    its track's raw fingerprint. a query then only has to touch the posting lists of its own hashes, rather
+    than every track in the library
+
+    candidates are scored by offset-aligned vote counting: every shared hash votes for the difference between
+    its offset in the track and its offset in the query. a real match has most of its votes land on the same
+    difference (the point in the track where the query starts), while coincidental hash collisions scatter
+
+    the index is built once at startup from tracks.raw_fingerprint (see main.cc), and is kept up to date by
+    TrackCtrl::fingerprint
+*/
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <algorithm>
+
+#include "storage.h"
+
+namespace server
+{
+
+struct FingerprintIndex
+{
+    struct Posting
+    {
+        uint64_t TRACK_ID;
+        uint32_t offset;
+    }; // Posting
+
+    struct Match
+    {
+        uint64_t TRACK_ID;
+        std::string title;
+        int matches; // votes at the best alignment
+        int64_t alignment; // offset (in fingerprint frames) into the track where the query lines up
+    }; // Match
+
+private:
+    // posting lists longer than this are treated as stop words (e.g. the hash of digital silence) and skipped
+    static constexpr size_t max_posting_length = 4096;
+
+    mutable std::shared_mutex shared_mutex;
+    std::unordered_map<uint32_t, std::vector<Posting>> postings;
+    // we keep each track's fingerprint so that re-fingerprinting a track can remove its old postings
+    std::unordered_map<uint64_t, std::vector<uint32_t>> fingerprints;
+    std::unordered_map<uint64_t, std::string> titles;
+    size_t posting_count { 0 };
+
+    // WARN: expects shared_mutex to already be held uniquely!
+    void insert_unlocked(uint64_t TRACK_ID, const std::string& title, const std::vector<uint32_t>& raw_fingerprint)
+    {
+        remove_unlocked(TRACK_ID);
+
+        for( uint32_t i = 0; i < raw_fingerprint.size(); i++ )
+            postings[ raw_fingerprint[i] ].push_back({ TRACK_ID, i });
+
+        posting_count += raw_fingerprint.size();
+        fingerprints[TRACK_ID] = raw_fingerprint;
+        titles[TRACK_ID] = title;
+    }
+
+    // WARN: expects shared_mutex to already be held uniquely!
+    void remove_unlocked(uint64_t TRACK_ID)
+    {
+        auto it = fingerprints.find(TRACK_ID);
+        if( it == fingerprints.end() ) return;
+
+        for( uint32_t hash : it->second )
+        {
+            auto posting_it = postings.find(hash);
+            if( posting_it == postings.end() ) continue;
+
+            std::vector<Posting>& list = posting_it->second;
+            size_t size_before = list.size();
+            list.erase( std::remove_if(list.begin(), list.end(), [TRACK_ID](const Posting& p) { return p.TRACK_ID == TRACK_ID; }), list.end() );
+            posting_count -= size_before - list.size();
+
+            if( list.empty() ) postings.erase(posting_it);
+        }
+
+        fingerprints.erase(it);
+        titles.erase(TRACK_ID);
+    }
+
+public:
+    static FingerprintIndex& get()
+    {
+        static FingerprintIndex singleton;
+        return singleton;
+    }
+
+    // (re)builds the entire index from every fingerprinted track in storage
+    void build(Storage& storage)
+    {
+        std::vector<Track> tracks = storage.get_all<Track>();
+
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        postings.clear();
+        fingerprints.clear();
+        titles.clear();
+        posting_count = 0;
+
+        for( const Track& track : tracks )
+        {
+            if( !track.raw_fingerprint || track.raw_fingerprint->empty() ) continue;
+            insert_unlocked(track.id, track.title, *track.raw_fingerprint);
+        }
+
+        LOG_INFO << "[FingerprintIndex::build] indexed " + std::to_string(fingerprints.size()) + " tracks (" + std::to_string(posting_count) + " hashes)";
+    }
+
+    // adds a track to the index, replacing any previous fingerprint it had
+    void insert(uint64_t TRACK_ID, const std::string& title, const std::vector<uint32_t>& raw_fingerprint)
+    {
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        insert_unlocked(TRACK_ID, title, raw_fingerprint);
+    }
+
+    void remove(uint64_t TRACK_ID)
+    {
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        remove_unlocked(TRACK_ID);
+    }
+
+    // returns (up to) max_results candidates, best first
+    std::vector<Match> query(const std::vector<uint32_t>& raw_fingerprint, size_t max_results = 10) const
+    {
+        // TRACK_ID -> (alignment -> votes)
+        std::unordered_map<uint64_t, std::unordered_map<int64_t, int>> votes;
+
+        std::shared_lock<std::shared_mutex> lock(shared_mutex);
+
+        for( uint32_t i = 0; i < raw_fingerprint.size(); i++ )
+        {
+            auto it = postings.find( raw_fingerprint[i] );
+            if( it == postings.end() || it->second.size() > max_posting_length ) continue;
+
+            for( const Posting& posting : it->second )
+                votes[posting.TRACK_ID][ static_cast<int64_t>(posting.offset) - i ]++;
+        }
+
+        std::vector<Match> matches;
+        matches.reserve(votes.size());
+        for( const auto& [TRACK_ID, alignments] : votes )
+        {
+            auto best = std::max_element(alignments.begin(), alignments.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+            matches.push_back({ TRACK_ID, titles.at(TRACK_ID), best->second, best->first });
+        }
+
+        lock.unlock();
+
+        std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.matches > b.matches; });
+        if( matches.size() > max_results ) matches.resize(max_results);
+
+        return matches;
+    }
+
+    Json::Value stats() const
+    {
+        std::shared_lock<std::shared_mutex> lock(shared_mutex);
+
+        Json::Value json;
+        json["tracks"] = static_cast<uint64_t>(fingerprints.size());
+        json["hashes"] = static_cast<uint64_t>(postings.size());
+        json["postings"] = static_cast<uint64_t>(posting_count);
+
+        return json;
+    }
+}; // FingerprintIndex
+
+} // server
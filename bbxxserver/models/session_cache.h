@@ -0,0 +1,120 @@
+#pragma once
+
+/*
+    SessionCache is an in-memory copy of the user_sessions table, so that AuthFilter never has to touch
+    sqlite on an authenticated request (or websocket handshake)
+
+    it is loaded from the db once at startup (see main.cc), and from then on kept in sync by AuthCtrl:
+    login inserts, logout removes. since every session is created through login, a uuid that isn't in the
+    cache doesn't exist, and no db lookup is needed to know that
+
+    expired sessions are swept out of both the cache and the db by sweep(), which main.cc runs on a timer
+*/
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "storage_pool.h"
+
+namespace server
+{
+
+struct SessionCache
+{
+private:
+    mutable std::shared_mutex shared_mutex;
+    std::unordered_map<std::string, UserSession> sessions;
+
+    mutable std::atomic<uint64_t> hits { 0 };
+    mutable std::atomic<uint64_t> misses { 0 };
+    std::atomic<uint64_t> swept { 0 };
+
+public:
+    static SessionCache& get()
+    {
+        static SessionCache singleton;
+        return singleton;
+    }
+
+    // replaces the cache with every unexpired session in storage
+    void load(Storage& storage, const int64_t seconds_since_epoch)
+    {
+        std::vector<UserSession> user_sessions = storage.get_all<UserSession>(
+            sqlite_orm::where(sqlite_orm::c(&UserSession::expire_time) > seconds_since_epoch)
+        );
+
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        sessions.clear();
+        for( UserSession& user_session : user_sessions ) sessions.emplace(user_session.uuid, std::move(user_session));
+
+        LOG_INFO << "[SessionCache::load] loaded " + std::to_string(sessions.size()) + " user sessions";
+    }
+
+    std::optional<UserSession> find(const std::string& uuid) const
+    {
+        std::shared_lock<std::shared_mutex> lock(shared_mutex);
+
+        auto it = sessions.find(uuid);
+        if( it == sessions.end() )
+        {
+            misses++;
+            return std::nullopt;
+        }
+
+        hits++;
+        return it->second;
+    }
+
+    void insert(const UserSession& user_session)
+    {
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        sessions[user_session.uuid] = user_session;
+    }
+
+    void remove(const std::string& uuid)
+    {
+        std::unique_lock<std::shared_mutex> lock(shared_mutex);
+        sessions.erase(uuid);
+    }
+
+    // drops expired sessions from the cache, and deletes their rows
+    void sweep(const int64_t seconds_since_epoch)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(shared_mutex);
+            count = std::erase_if(sessions, [seconds_since_epoch](const auto& pair) { return pair.second.expired(seconds_since_epoch); });
+        }
+        swept += count;
+
+        try
+        {
+            StoragePool::get().storage().remove_all<UserSession>(
+                sqlite_orm::where(sqlite_orm::c(&UserSession::expire_time) <= seconds_since_epoch)
+            );
+        }
+        catch(const std::exception& e)
+        {
+            LOG_ERROR << "[SessionCache::sweep] db error: " << e.what();
+        }
+
+        if( count > 0 ) LOG_INFO << "[SessionCache::sweep] swept " + std::to_string(count) + " expired user sessions";
+    }
+
+    Json::Value stats() const
+    {
+        Json::Value json;
+        {
+            std::shared_lock<std::shared_mutex> lock(shared_mutex);
+            json["sessions"] = static_cast<uint64_t>(sessions.size());
+        }
+        json["hits"] = hits.load();
+        json["misses"] = misses.load();
+        json["swept"] = swept.load();
+
+        return json;
+    }
+}; // SessionCache
+
+} // server
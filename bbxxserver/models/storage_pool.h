@@ -0,0 +1,127 @@
+#pragma once
+
+/*
+    StoragePool keeps one open server::Storage per thread, so that drogon's event-loop threads each reuse
+    a single connection to bx.db instead of constructing (and opening) a fresh storage on every request
+
+    the hot queries (get by id, get_all) also go through here. their prepared statements are compiled once
+    per thread and rebound on every call, so sqlite never has to re-parse the same SQL twice
+
+    hit/miss counters are global across all threads. a miss means a thread had to open its connection (or
+    compile a statement), and a hit means it got to reuse one. see StatsCtrl for where these are exposed
+*/
+
+#include <atomic>
+
+#include "storage.h"
+
+namespace server
+{
+
+struct StoragePool
+{
+private:
+    // how long a connection will wait on another connection's write lock before giving up
+    static constexpr int busy_timeout_ms = 5000;
+
+    std::atomic<uint64_t> hits { 0 };
+    std::atomic<uint64_t> misses { 0 };
+    std::atomic<uint64_t> statement_hits { 0 };
+    std::atomic<uint64_t> statement_misses { 0 };
+    std::atomic<uint64_t> connections { 0 };
+
+    struct Connection
+    {
+        Storage storage;
+
+        Connection() : storage(init_storage())
+        {
+            storage.open_forever(); // prepared statements are only valid for as long as the connection is
+            storage.busy_timeout(busy_timeout_ms);
+
+            StoragePool::get().connections++;
+        }
+        ~Connection() { StoragePool::get().connections--; }
+    }; // Connection
+
+    Connection& this_thread()
+    {
+        // we could key this off of trantor::EventLoop::getEventLoopOfCurrentThread(), but each drogon
+        // event loop owns exactly one thread anyways, so thread_local gives us the same thing for free
+        thread_local std::unique_ptr<Connection> connection;
+
+        if( connection ) hits++;
+        else
+        {
+            misses++;
+            connection = std::make_unique<Connection>();
+        }
+
+        return *connection;
+    }
+
+    // prepares statement the first time a thread asks for it, and rebinds it every time after that
+    // WARN: thread_local statements are destroyed before this_thread()'s connection, since they are always
+    // constructed after it. if that ever stops being the case, sqlite3_close will fail with SQLITE_BUSY!
+    template<typename Statement, typename Prepare>
+    Statement& prepared(Storage& storage, Prepare&& prepare)
+    {
+        thread_local std::unique_ptr<Statement> statement;
+
+        if( statement ) statement_hits++;
+        else
+        {
+            statement_misses++;
+            statement = std::make_unique<Statement>( prepare(storage) );
+        }
+
+        return *statement;
+    }
+
+public:
+    static StoragePool& get()
+    {
+        static StoragePool singleton;
+        return singleton;
+    }
+
+    // the calling thread's storage. use this for anything that isn't one of the prepared queries below
+    Storage& storage() { return this_thread().storage; }
+
+    template<typename T, typename Id>
+    std::optional<T> get_optional(const Id& id)
+    {
+        Storage& storage = this_thread().storage;
+
+        auto prepare = [](Storage& s) { return s.prepare( sqlite_orm::get_optional<T>(Id{}) ); };
+        auto& statement = prepared<decltype(prepare(storage)), decltype(prepare)>(storage, std::move(prepare));
+
+        sqlite_orm::get<0>(statement) = id;
+        return storage.execute(statement);
+    }
+
+    template<typename T>
+    std::vector<T> get_all()
+    {
+        Storage& storage = this_thread().storage;
+
+        auto prepare = [](Storage& s) { return s.prepare( sqlite_orm::get_all<T>() ); };
+        auto& statement = prepared<decltype(prepare(storage)), decltype(prepare)>(storage, std::move(prepare));
+
+        return storage.execute(statement);
+    }
+
+    Json::Value stats() const
+    {
+        Json::Value json;
+        json["hits"] = hits.load();
+        json["misses"] = misses.load();
+        json["statement_hits"] = statement_hits.load();
+        json["statement_misses"] = statement_misses.load();
+        json["connections"] = connections.load();
+
+        return json;
+    }
+}; // StoragePool
+
+} // server
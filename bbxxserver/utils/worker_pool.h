@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    WorkerPool is a small, bounded pool of threads for CPU-heavy work (fingerprinting, bcrypt, ...) that
+    would otherwise run inside a drogon event-loop callback and stall every other connection on that loop
+
+    handlers validate their request as usual, then hand the expensive part to respond_async(). the work runs
+    on a worker thread, and its response is passed back to the event loop that the request came in on
+
+    the queue has a fixed depth. once it is full, new work is rejected straight away with a 503 instead of
+    piling up behind what's already queued
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <drogon/HttpResponse.h>
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/Logger.h>
+
+namespace server
+{
+
+struct WorkerPool
+{
+private:
+    static constexpr size_t max_queue_depth = 64;
+
+    std::mutex mutex;
+    std::condition_variable condition_variable;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+    bool stopping { false };
+
+    std::atomic<uint64_t> completed { 0 };
+    std::atomic<uint64_t> rejected { 0 };
+    std::atomic<uint64_t> busy { 0 };
+
+    WorkerPool()
+    {
+        size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+        threads.reserve(thread_count);
+        for( size_t i = 0; i < thread_count; i++ ) threads.emplace_back(&WorkerPool::work, this);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition_variable.notify_all();
+
+        for( std::thread& thread : threads ) thread.join();
+    }
+
+    void work()
+    {
+        while( true )
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition_variable.wait(lock, [this] { return stopping || !queue.empty(); });
+
+                if( stopping && queue.empty() ) return;
+
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            busy++;
+            task();
+            busy--;
+            completed++;
+        }
+    }
+
+public:
+    static WorkerPool& get()
+    {
+        static WorkerPool singleton;
+        return singleton;
+    }
+
+    // queues task, or returns false if the queue is already full
+    bool submit(std::function<void()>&& task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if( queue.size() >= max_queue_depth )
+            {
+                rejected++;
+                return false;
+            }
+
+            queue.push_back(std::move(task));
+        }
+        condition_variable.notify_one();
+
+        return true;
+    }
+
+    // runs work on a worker thread, then calls callback with its response back on the calling event loop
+    // if the queue is full, callback is immediately given a 503
+    void respond_async(std::function<drogon::HttpResponsePtr()>&& work, std::function<void(const drogon::HttpResponsePtr &)>&& callback)
+    {
+        trantor::EventLoop* loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+
+        auto shared_callback = std::make_shared<std::function<void(const drogon::HttpResponsePtr &)>>(std::move(callback));
+        bool queued = submit([loop, work = std::move(work), shared_callback]()
+        {
+            drogon::HttpResponsePtr resp;
+            try { resp = work(); }
+            catch(const std::exception& e)
+            {
+                LOG_ERROR << "[WorkerPool::respond_async] work threw: " << e.what();
+
+                resp = drogon::HttpResponse::newHttpResponse(drogon::k500InternalServerError, drogon::ContentType::CT_TEXT_HTML);
+                resp->setBody("something went wrong! :(");
+            }
+
+            if( loop ) loop->queueInLoop([shared_callback, resp]() { (*shared_callback)(resp); });
+            else (*shared_callback)(resp);
+        });
+
+        if( !queued )
+        {
+            drogon::HttpResponsePtr resp = drogon::HttpResponse::newHttpResponse(drogon::k503ServiceUnavailable, drogon::ContentType::CT_TEXT_HTML);
+            resp->addHeader("Retry-After", "1");
+            resp->setBody("server is busy! please try again in a moment");
+
+            (*shared_callback)(resp);
+        }
+    }
+
+    Json::Value stats()
+    {
+        Json::Value json;
+        json["threads"] = static_cast<uint64_t>(threads.size());
+        json["busy"] = busy.load();
+        json["completed"] = completed.load();
+        json["rejected"] = rejected.load();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            json["queued"] = static_cast<uint64_t>(queue.size());
+        }
+        json["max_queue_depth"] = static_cast<uint64_t>(max_queue_depth);
+
+        return json;
+    }
+}; // WorkerPool
+
+} // server
@@ -0,0 +1,335 @@
+/*
+    headless benchmark for the dsp graph (src/dsp/). builds patches out of the same DSPNodes DSPGraphEdit spawns,
+    compiles them into a Plan, and renders them offline as fast as it can: no godot, and an ma_engine without a
+    device (miniaudio's null backend would pace itself to realtime), read from directly
+
+    g++ -std=c++17 -O2 -Isrc bench/dsp_bench.cpp src/miniaudio_implementation.cpp -o dsp_bench -lpthread -ldl -lm
+    ./dsp_bench [--seconds 10] [--patch name] [--csv]
+
+    for each patch, reports:
+        - ns per frame for each step of its plan (a node, a fused pair of nodes, or a mix), timed around each step
+        - ns per frame and the realtime factor for the whole patch rendered through ma_engine_read_pcm_frames (so
+          with miniaudio's node graph and plan_node's command handling on top)
+        - how many times operator new was called while rendering, which should always be 0, since the audio thread
+          must never allocate
+
+    exits with 1 if any patch allocated while rendering, so CI fails on it. --csv prints one line per measurement
+    instead of the tables, for CI to keep and compare between runs
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "miniaudio.h"
+
+#include "dsp/filter_node.h"
+#include "dsp/multiplier_node.h"
+#include "dsp/oscillator_node.h"
+#include "dsp/output_node.h"
+#include "dsp/plan.h"
+#include "dsp/simd.h"
+
+using namespace rhythm::dsp;
+
+/* ALLOCATIONS */
+
+static std::atomic<uint64_t> allocation_count { 0 };
+
+// (none of these are inlined: gcc would then see eg. free() called on what came from operator new, or new[] paired
+// with delete, and warn that they don't match)
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if( void* p = malloc(size ? size : 1) ) return p;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void* operator new[](size_t size) { return operator new(size); }
+[[gnu::noinline]] void operator delete(void* p) noexcept { free(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { free(p); }
+[[gnu::noinline]] void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/* PATCHES */
+
+static constexpr ma_uint32 channels { 2 };
+static constexpr ma_uint32 sample_rate { 48000 };
+static constexpr ma_uint32 block_size { 512 }; // (frames per engine read)
+
+struct Patch
+{
+    ma_engine* engine { nullptr };
+    std::string name;
+    std::vector<std::unique_ptr<DSPNode>> nodes;
+    std::map<const DSPNode*, std::string> labels;
+    std::vector<Edge> edges;
+    OutputNode output;
+
+    std::function<void(uint64_t block)> every_block; // (optional, called on the "game thread" between blocks)
+
+    template<typename T>
+    T* add(const std::string& label)
+    {
+        T* node = new T();
+        node->init(engine);
+        nodes.emplace_back(node);
+        labels[node] = label;
+        return node;
+    }
+
+    void connect(DSPNode* from, DSPNode* to, uint32_t to_port = 0) { edges.push_back({ from, 0, to, to_port }); }
+
+    std::string label(const Plan::Step& step) const
+    {
+        if( !step.node ) return "mix of " + std::to_string(step.mix_count);
+        std::string l = labels.at(step.node);
+        if( step.gain ) l += " * " + labels.at(step.gain);
+        return l;
+    }
+}; // Patch
+
+static std::vector<std::unique_ptr<Patch>> make_patches(ma_engine* engine)
+{
+    std::vector<std::unique_ptr<Patch>> patches;
+    auto patch = [&](const char* name)
+    {
+        patches.push_back(std::make_unique<Patch>());
+        patches.back()->engine = engine;
+        patches.back()->name = name;
+        return patches.back().get();
+    };
+
+    {
+        Patch* p = patch("sine");
+        OscillatorNode* osc = p->add<OscillatorNode>("sine");
+        p->connect(osc, &p->output);
+    }
+    {
+        Patch* p = patch("sawtooth");
+        OscillatorNode* osc = p->add<OscillatorNode>("sawtooth");
+        osc->type = ma_waveform_type_sawtooth;
+        p->connect(osc, &p->output);
+    }
+    {
+        Patch* p = patch("gain");
+        OscillatorNode* osc = p->add<OscillatorNode>("sine");
+        MultiplierNode* gain = p->add<MultiplierNode>("gain");
+        gain->multiplier.set(0.5f);
+        p->connect(osc, gain);
+        p->connect(gain, &p->output);
+    }
+    {
+        Patch* p = patch("fm");
+        OscillatorNode* lfo = p->add<OscillatorNode>("lfo");
+        lfo->frequency.set(6.0f);
+        lfo->amplitude.set(1.0f);
+        MultiplierNode* depth = p->add<MultiplierNode>("depth");
+        depth->multiplier.set(30.0f);
+        OscillatorNode* carrier = p->add<OscillatorNode>("carrier");
+        carrier->type = ma_waveform_type_square;
+        p->connect(lfo, depth);
+        p->connect(depth, carrier, 0);
+        p->connect(carrier, &p->output);
+    }
+    {
+        Patch* p = patch("filter");
+        OscillatorNode* osc = p->add<OscillatorNode>("sawtooth");
+        osc->type = ma_waveform_type_sawtooth;
+        FilterNode* filter = p->add<FilterNode>("lpf x4");
+        filter->set_stages(4);
+        p->connect(osc, filter);
+        p->connect(filter, &p->output);
+    }
+    {
+        // (every parameter ramping, all the time)
+        Patch* p = patch("ramps");
+        OscillatorNode* osc = p->add<OscillatorNode>("sine");
+        MultiplierNode* gain = p->add<MultiplierNode>("gain");
+        p->connect(osc, gain);
+        p->connect(gain, &p->output);
+        p->every_block = [osc, gain](uint64_t block)
+        {
+            osc->frequency.set( (block % 2) ? 220.0f : 880.0f );
+            osc->amplitude.set( (block % 3) ? 0.2f : 0.8f );
+            gain->multiplier.set( (block % 2) ? 0.5f : 1.0f );
+        };
+    }
+    {
+        // (new coefficients every block, so it's always gliding, see FilterNode)
+        Patch* p = patch("filter sweep");
+        OscillatorNode* osc = p->add<OscillatorNode>("sawtooth");
+        osc->type = ma_waveform_type_sawtooth;
+        FilterNode* filter = p->add<FilterNode>("lpf x2");
+        filter->set_stages(2);
+        p->connect(osc, filter);
+        p->connect(filter, &p->output);
+        p->every_block = [filter](uint64_t block)
+        {
+            filter->collect();
+            filter->set_cutoff( (block % 2) ? 200.0 : 4000.0 );
+            filter->set_q( (block % 3) ? 0.7 : 4.0 );
+        };
+    }
+    {
+        Patch* p = patch("big");
+        FilterNode* filter = p->add<FilterNode>("lpf x2");
+        filter->set_stages(2);
+        for( int i = 0; i < 16; i++ )
+        {
+            OscillatorNode* osc = p->add<OscillatorNode>("sawtooth " + std::to_string(i));
+            osc->type = ma_waveform_type_sawtooth;
+            osc->frequency.set(55.0f*(i + 1));
+            osc->amplitude.set(0.05f);
+            p->connect(osc, filter);
+        }
+        MultiplierNode* gain = p->add<MultiplierNode>("gain");
+        gain->multiplier.set(0.8f);
+        p->connect(filter, gain);
+        p->connect(gain, &p->output);
+    }
+
+    return patches;
+}
+
+/* MEASURING */
+
+using clock_type = std::chrono::steady_clock;
+
+static double seconds_since(clock_type::time_point start) { return std::chrono::duration<double>(clock_type::now() - start).count(); }
+
+struct Result
+{
+    std::vector<std::pair<std::string, double>> steps; // label, ns per frame
+    double steps_ns { 0.0 };
+    double engine_ns { 0.0 };
+    double realtime_factor { 0.0 };
+    uint64_t allocations { 0 };
+    size_t buffers { 0 };
+    uint32_t fused { 0 };
+}; // Result
+
+static Result run(Patch& patch, ma_engine* engine, double seconds)
+{
+    Result result;
+    const uint64_t blocks = static_cast<uint64_t>( seconds*sample_rate / block_size );
+    const double frames = double(blocks)*block_size;
+
+    // each step, timed on its own
+    std::unique_ptr<Plan> plan = Plan::compile(patch.edges, &patch.output, channels);
+    result.buffers = plan->buffer_count;
+    result.fused = plan->fused_count;
+
+    std::vector<double> step_seconds(plan->steps.size(), 0.0);
+    allocation_count.store(0);
+    for( uint64_t b = 0; b < blocks; b++ )
+    {
+        if( patch.every_block ) patch.every_block(b);
+        for( size_t s = 0; s < plan->steps.size(); s++ )
+        {
+            const clock_type::time_point start = clock_type::now();
+            plan->run_step(plan->steps[s], block_size);
+            step_seconds[s] += seconds_since(start);
+        }
+    }
+    result.allocations += allocation_count.load();
+
+    for( size_t s = 0; s < plan->steps.size(); s++ )
+    {
+        const double ns = step_seconds[s]*1e9 / frames;
+        result.steps.push_back({ patch.label(plan->steps[s]), ns });
+        result.steps_ns += ns;
+    }
+
+    // the whole patch, through the engine
+    plan_node node;
+    if( node.init(engine) != MA_SUCCESS ) { fprintf(stderr, "couldn't init plan_node\n"); exit(2); }
+    node.publish(Plan::compile(patch.edges, &patch.output, channels));
+
+    std::vector<float> out(size_t(block_size)*channels);
+    allocation_count.store(0);
+    const clock_type::time_point start = clock_type::now();
+    for( uint64_t b = 0; b < blocks; b++ )
+    {
+        if( patch.every_block ) patch.every_block(b);
+        ma_engine_read_pcm_frames(engine, out.data(), block_size, nullptr);
+    }
+    const double elapsed = seconds_since(start);
+    result.allocations += allocation_count.load();
+
+    node.collect();
+    node.uninit();
+
+    result.engine_ns = elapsed*1e9 / frames;
+    result.realtime_factor = (frames / sample_rate) / elapsed;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 10.0;
+    const char* only = nullptr;
+    bool csv = false;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( !strcmp(argv[i], "--seconds") && i + 1 < argc ) seconds = atof(argv[++i]);
+        else if( !strcmp(argv[i], "--patch") && i + 1 < argc ) only = argv[++i];
+        else if( !strcmp(argv[i], "--csv") ) csv = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds 10] [--patch name] [--csv]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ma_engine_config engine_config = ma_engine_config_init();
+    engine_config.noDevice = MA_TRUE;
+    engine_config.channels = channels;
+    engine_config.sampleRate = sample_rate;
+
+    ma_engine engine;
+    if( ma_engine_init(&engine_config, &engine) != MA_SUCCESS )
+    {
+        fprintf(stderr, "couldn't init the engine\n");
+        return 2;
+    }
+
+    if( csv ) printf("patch,step,ns_per_frame\n");
+    else printf("dsp_bench: %.0f s per patch at %u Hz, %u channels, %u frame blocks, simd: %s\n", seconds, sample_rate, channels, block_size, simd::name);
+
+    bool allocated = false;
+    std::vector<std::unique_ptr<Patch>> patches = make_patches(&engine);
+    for( auto& patch : patches )
+    {
+        if( only && patch->name != only ) continue;
+
+        const Result result = run(*patch, &engine, seconds);
+        allocated |= ( result.allocations > 0 );
+
+        if( csv )
+        {
+            for( const auto& [label, ns] : result.steps ) printf("%s,%s,%.3f\n", patch->name.c_str(), label.c_str(), ns);
+            printf("%s,(steps),%.3f\n", patch->name.c_str(), result.steps_ns);
+            printf("%s,(engine),%.3f\n", patch->name.c_str(), result.engine_ns);
+            printf("%s,(allocations),%llu\n", patch->name.c_str(), (unsigned long long)result.allocations);
+            continue;
+        }
+
+        printf("\npatch '%s': %zu steps, %zu buffers, %u fused\n", patch->name.c_str(), result.steps.size(), result.buffers, result.fused);
+        for( const auto& [label, ns] : result.steps ) printf("    %-28s %8.2f ns/frame\n", label.c_str(), ns);
+        printf("    %-28s %8.2f ns/frame\n", "(all steps)", result.steps_ns);
+        printf("    %-28s %8.2f ns/frame, %.0fx realtime, %llu allocations\n", "(engine)", result.engine_ns, result.realtime_factor, (unsigned long long)result.allocations);
+    }
+
+    ma_engine_uninit(&engine);
+
+    if( allocated ) fprintf(stderr, "dsp_bench: the audio thread allocated!\n");
+    return allocated ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+    microbenchmark for dsp::oscillator (src/dsp/oscillator.h), against how oscillator_node::process used to render:
+    one ma_waveform_set_frequency / set_amplitude / read_pcm_frames(..., 1, ...) per frame. the oscillator is run
+    both with its naive shapes and band-limited (from the tables in src/dsp/wavetable.h)
+
+    g++ -std=c++17 -O2 -Isrc bench/oscillator_bench.cpp src/miniaudio_implementation.cpp -o oscillator_bench -lpthread -ldl -lm
+    ./oscillator_bench
+
+    reports ns per (stereo) frame for each waveform, with and without audio-rate modulation, the largest
+    difference between ma_waveform's and the naive oscillator's output (without modulation, where they should
+    agree), and how loud aliasing is at a C8 (the level of its 11th harmonic, folded back down to 1954 Hz,
+    relative to the fundamental)
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "miniaudio.h"
+
+#include "dsp/oscillator.h"
+#include "dsp/wavetable.h"
+
+static constexpr ma_uint32 channels { 2 };
+static constexpr ma_uint32 sample_rate { 48000 };
+static constexpr ma_uint32 block_size { 512 }; // (frames per process call)
+static constexpr int blocks { 4000 };
+
+// what oscillator_node::process used to do
+static void process_per_frame(ma_waveform* waveform, double frequency, double amplitude, const float* frequency_in, const float* amplitude_in, float* out, ma_uint32 frame_count)
+{
+    for( ma_uint32 i = 0; i < frame_count; i++ )
+    {
+        double f = frequency;
+        if( frequency_in ) f += frequency_in[i*channels];
+        ma_waveform_set_frequency(waveform, f);
+
+        double a = amplitude;
+        if( amplitude_in ) a *= (1 + amplitude_in[i*channels]);
+        ma_waveform_set_amplitude(waveform, a);
+
+        ma_waveform_read_pcm_frames(waveform, &out[i*channels], 1, nullptr);
+    }
+}
+
+// the level of frequency in signal (mono) relative to reference, in dB (goertzel)
+static double level_db(const std::vector<float>& signal, double frequency, double reference)
+{
+    auto power = [&](double f)
+    {
+        const double coefficient = 2.0*cos(2.0*M_PI*f / sample_rate);
+        double s1 = 0.0, s2 = 0.0;
+        for( const float x : signal )
+        {
+            const double s0 = x + coefficient*s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        return s1*s1 + s2*s2 - coefficient*s1*s2;
+    };
+
+    return 10.0*log10( power(frequency) / power(reference) + 1e-30 );
+}
+
+template<typename F>
+static double ns_per_frame(F&& process)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for( int b = 0; b < blocks; b++ ) process();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return ns / (double(blocks)*block_size);
+}
+
+int main()
+{
+    const char* names[] { "sine", "square", "triangle", "sawtooth" };
+
+    // a 5 Hz vibrato and tremolo, as if from another oscillator
+    std::vector<float> frequency_in(block_size*channels), amplitude_in(block_size*channels);
+    for( ma_uint32 i = 0; i < block_size; i++ )
+        for( ma_uint32 c = 0; c < channels; c++ )
+        {
+            frequency_in[i*channels + c] = 20.0f*sinf(6.2831853f*5.0f*i/sample_rate);
+            amplitude_in[i*channels + c] = 0.3f*sinf(6.2831853f*5.0f*i/sample_rate);
+        }
+
+    std::vector<float> out(block_size*channels), reference(block_size*channels);
+    volatile float sink = 0.0f; // (so the compiler can't skip anything)
+
+    const auto start = std::chrono::steady_clock::now();
+    rhythm::dsp::wavetable_bank::get();
+    printf("dsp::oscillator (%s) vs per frame ma_waveform, %u frame blocks, %u channels\n", rhythm::dsp::simd::name, block_size, channels);
+    printf("(wavetable bank built in %.1f ms)\n\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    printf("%-10s %-10s %14s %14s %14s %12s %13s %13s\n", "waveform", "modulated", "ma_waveform", "naive", "band-limited", "max error", "alias naive", "alias band-l.");
+
+    for( int type = ma_waveform_type_sine; type <= ma_waveform_type_sawtooth; type++ )
+        for( const bool modulated : { false, true } )
+        {
+            const float* f_in = modulated ? frequency_in.data() : nullptr;
+            const float* a_in = modulated ? amplitude_in.data() : nullptr;
+
+            ma_waveform_config config = ma_waveform_config_init(ma_format_f32, channels, sample_rate, (ma_waveform_type)type, 0.5, 440.0);
+            ma_waveform waveform;
+            ma_waveform_init(&config, &waveform);
+
+            rhythm::dsp::oscillator naive;
+            naive.sample_rate = sample_rate;
+            naive.band_limited = false;
+
+            rhythm::dsp::oscillator band_limited;
+            band_limited.sample_rate = sample_rate;
+
+            // (only comparable over the first second or so, where neither has drifted from the other)
+            float max_error = 0.0f;
+            if( !modulated )
+            {
+                for( ma_uint32 b = 0; b < sample_rate / block_size; b++ )
+                {
+                    process_per_frame(&waveform, 440.0, 0.5, nullptr, nullptr, reference.data(), block_size);
+                    naive.process((ma_waveform_type)type, 440.0f, 0.5f, nullptr, nullptr, channels, out.data(), channels, block_size);
+
+                    for( size_t i = 0; i < out.size(); i++ )
+                    {
+                        // (the square's and sawtooth's edges can land a frame apart from rounding alone)
+                        if( (type == ma_waveform_type_square || type == ma_waveform_type_sawtooth) && fabsf(out[i] - reference[i]) > 0.9f ) continue;
+                        max_error = fmaxf(max_error, fabsf(out[i] - reference[i]));
+                    }
+                }
+            }
+
+            const double before = ns_per_frame([&]
+            {
+                process_per_frame(&waveform, 440.0, 0.5, f_in, a_in, reference.data(), block_size);
+                sink = sink + reference[0];
+            });
+            const double after_naive = ns_per_frame([&]
+            {
+                naive.process((ma_waveform_type)type, 440.0f, 0.5f, f_in, a_in, channels, out.data(), channels, block_size);
+                sink = sink + out[0];
+            });
+            const double after_band_limited = ns_per_frame([&]
+            {
+                band_limited.process((ma_waveform_type)type, 440.0f, 0.5f, f_in, a_in, channels, out.data(), channels, block_size);
+                sink = sink + out[0];
+            });
+
+            printf("%-10s %-10s %11.2f ns %11.2f ns %11.2f ns ", names[type], modulated ? "yes" : "no", before, after_naive, after_band_limited);
+            if( modulated )
+            {
+                printf("%12s %13s %13s\n", "-", "-", "-");
+                continue;
+            }
+
+            // aliasing, from one second of a C8
+            const float c8 = 4186.01f;
+            std::vector<float> mono(sample_rate), stereo(sample_rate*channels);
+            double alias[2];
+            for( const bool is_band_limited : { false, true } )
+            {
+                rhythm::dsp::oscillator oscillator;
+                oscillator.sample_rate = sample_rate;
+                oscillator.band_limited = is_band_limited;
+                oscillator.process((ma_waveform_type)type, c8, 0.5f, nullptr, nullptr, channels, stereo.data(), channels, sample_rate);
+
+                for( ma_uint32 i = 0; i < sample_rate; i++ ) mono[i] = stereo[i*channels];
+                alias[is_band_limited] = level_db(mono, sample_rate - 11*c8, c8);
+            }
+            printf("%12.2e %10.1f dB %10.1f dB\n", max_error, alias[0], alias[1]);
+
+            ma_waveform_uninit(&waveform);
+        }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+    AsyncDecode fully decodes an audio file into f32 PCM on its own thread, so that AudioEngine2 can keep
+    streaming the same file in the meantime and swap over once it's done (see AudioEngine2::decode_current_track)
+
+    the PCM is decoded to the same format the resource manager streams in (f32, native channels, engine sample
+    rate), so a frame of the decoded sound is the same frame of the streamed one, and the Conductor never has
+    to know the sound changed underneath it
+
+    a file that's already in memory (or can be mapped, see decode_in_place) is decoded straight out of it, and
+    only anything else is read through the vfs
+
+    once decoded, the PCM is also written to the PCMCache (from the decode thread), so next time there's
+    nothing to decode at all
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "miniaudio.h"
+
+#include "MappedFile.h"
+#include "PCMCache.h"
+
+namespace rhythm
+{
+
+struct AsyncDecode
+{
+    /* STATE */
+
+    std::string path;
+    std::thread thread;
+    const PCMCache* cache { nullptr };
+    std::string cache_key;
+
+    // the file's bytes, if it's decoded in place (mapping keeps them alive, if it's not a slice of something else)
+    const uint8_t* data { nullptr };
+    uint64_t data_size { 0 };
+    std::unique_ptr<MappedFile> mapping;
+
+    std::atomic<float> progress { 0.0 }; // 0 to 1, or stays at 0 if the length of the file isn't known upfront
+    std::atomic<bool> done { false };
+    std::atomic<bool> cancelled { false };
+
+    // only valid once done is true
+    ma_result result { MA_ERROR };
+    std::vector<float> pcm;
+    ma_uint32 channels { 0 };
+    ma_uint32 sample_rate { 0 };
+    ma_uint64 length_in_frames { 0 };
+
+    /* OPERATIONS */
+
+    // decode p_data instead of reading the file through the vfs (call before start). p_data has to outlive the
+    // decode, which it does if p_mapping is what maps it
+    void decode_in_place(const uint8_t* p_data, uint64_t p_size, std::unique_ptr<MappedFile> p_mapping = nullptr)
+    {
+        data = p_data;
+        data_size = p_size;
+        mapping = std::move(p_mapping);
+    }
+
+    void start(ma_vfs* p_vfs, const std::string& p_path, ma_uint32 p_sample_rate, const PCMCache* p_cache = nullptr, const std::string& p_cache_key = "")
+    {
+        path = p_path;
+        sample_rate = p_sample_rate;
+        cache = p_cache;
+        cache_key = p_cache_key;
+        thread = std::thread(&AsyncDecode::decode, this, p_vfs);
+    }
+
+    // asks the decode to stop early, and waits for the thread either way
+    void cancel()
+    {
+        cancelled.store(true, std::memory_order_relaxed);
+        if( thread.joinable() ) thread.join();
+    }
+
+    ~AsyncDecode() { cancel(); }
+
+private:
+    void decode(ma_vfs* p_vfs)
+    {
+        ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 0, sample_rate);
+        ma_decoder decoder;
+        result = data ? ma_decoder_init_memory(data, static_cast<size_t>(data_size), &decoder_config, &decoder) : ma_decoder_init_vfs(p_vfs, path.c_str(), &decoder_config, &decoder);
+        if( result != MA_SUCCESS )
+        {
+            done.store(true, std::memory_order_release);
+            return;
+        }
+
+        channels = decoder.outputChannels;
+
+        ma_uint64 expected_length = 0;
+        ma_decoder_get_length_in_pcm_frames(&decoder, &expected_length); // (0 if it can't be known without decoding)
+        if( expected_length > 0 ) pcm.reserve(expected_length*channels);
+
+        // decode in chunks, so that we can report progress and be cancelled
+        const ma_uint64 chunk_in_frames = 16384;
+        while( !cancelled.load(std::memory_order_relaxed) )
+        {
+            const size_t offset = pcm.size();
+            pcm.resize(offset + chunk_in_frames*channels);
+
+            ma_uint64 frames_read = 0;
+            result = ma_decoder_read_pcm_frames(&decoder, pcm.data() + offset, chunk_in_frames, &frames_read);
+            pcm.resize(offset + frames_read*channels);
+            length_in_frames += frames_read;
+
+            if( expected_length > 0 ) progress.store(std::min(1.0f, static_cast<float>(length_in_frames) / expected_length), std::memory_order_relaxed);
+            if( result != MA_SUCCESS || frames_read < chunk_in_frames ) break;
+        }
+
+        // reaching the end of the file is how we expect to finish
+        if( result == MA_AT_END ) result = MA_SUCCESS;
+        if( result == MA_SUCCESS && length_in_frames == 0 ) result = MA_INVALID_FILE;
+        if( cancelled.load(std::memory_order_relaxed) ) result = MA_CANCELLED;
+        pcm.shrink_to_fit();
+
+        ma_decoder_uninit(&decoder);
+        mapping.reset(); // (done with the file)
+
+        if( result == MA_SUCCESS && cache ) cache->store(cache_key, channels, sample_rate, pcm.data(), length_in_frames);
+
+        progress.store(1.0, std::memory_order_relaxed);
+        done.store(true, std::memory_order_release);
+    }
+}; // AsyncDecode
+
+} // rhythm
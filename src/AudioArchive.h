@@ -0,0 +1,180 @@
+#pragma once
+
+/*
+    AudioArchive is every audio file baked into the game, packed into one file (built by tools/pack_audio.py), so
+    that AudioEngine2 opens a single file once at startup instead of opening each audio file as it's loaded.
+    opening a file in the archive is then just a binary search of its index (see ma_vfs_mmap.h)
+
+    layout (all little-endian):
+        Header                  64 bytes
+        Entry[entry_count]      sorted by path (bytewise), 24 bytes each
+        path strings            utf8, not null terminated, each Entry points into these
+        file data               each file starts on a multiple of Header::alignment
+
+    paths are relative to the project, so "res://audio/click.wav" and "audio/click.wav" both find "audio/click.wav"
+
+    the archive is either memory-mapped (when it's on the real filesystem, eg. running from the editor), in which
+    case each file is just a view into the mapping, or read through read_at (eg. when it's inside the .pck)
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace rhythm
+{
+
+struct AudioArchive
+{
+    struct Header
+    {
+        char magic[4] { 'B', 'X', 'A', 'A' };
+        uint32_t version { 1 };
+        uint32_t entry_count { 0 };
+        uint32_t alignment { 4096 };
+        uint64_t strings_offset { 0 };
+        uint64_t strings_size { 0 };
+        uint8_t reserved[32] {};
+    }; // Header
+    static_assert(sizeof(Header) == 64);
+
+    struct Entry
+    {
+        uint64_t offset { 0 }; // from the start of the archive
+        uint64_t length { 0 };
+        uint32_t path_offset { 0 }; // into the path strings
+        uint32_t path_length { 0 };
+    }; // Entry
+    static_assert(sizeof(Entry) == 24);
+
+    // reads size bytes at offset in the archive into dst, returning how many it read. has to be thread safe
+    using ReadAt = std::function<uint64_t(uint64_t offset, void* dst, uint64_t size)>;
+
+    /* STATE */
+
+private:
+    std::vector<Entry> entries;
+    std::string strings;
+
+    std::unique_ptr<MappedFile> mapping;
+    ReadAt read_at;
+
+public:
+    /* LEMMAS */
+
+    bool is_mounted() const { return static_cast<bool>(read_at); }
+    size_t size() const { return entries.size(); }
+
+    std::string_view path_of(const Entry& entry) const { return std::string_view(strings).substr(entry.path_offset, entry.path_length); }
+
+    // "res://audio/click.wav" -> "audio/click.wav"
+    static std::string_view normalize(std::string_view path)
+    {
+        if( path.substr(0, 6) == "res://" ) path.remove_prefix(6);
+        while( path.substr(0, 2) == "./" ) path.remove_prefix(2);
+        return path;
+    }
+
+    // the entry for path, or nullptr if it isn't in the archive
+    const Entry* find(std::string_view path) const
+    {
+        path = normalize(path);
+
+        auto it = std::lower_bound(entries.begin(), entries.end(), path, [this](const Entry& entry, std::string_view p) { return path_of(entry) < p; });
+        return ( it != entries.end() && path_of(*it) == path ) ? &*it : nullptr;
+    }
+
+    // entry's data, if the archive is mapped (nullptr otherwise, use read instead)
+    const uint8_t* data(const Entry& entry) const { return mapping ? mapping->data() + entry.offset : nullptr; }
+
+    // reads from entry's data, starting position bytes in
+    uint64_t read(const Entry& entry, uint64_t position, void* dst, uint64_t size) const
+    {
+        if( position >= entry.length ) return 0;
+        return read_at(entry.offset + position, dst, std::min(size, entry.length - position));
+    }
+
+    /* OPERATIONS */
+
+    bool mount(std::unique_ptr<MappedFile> p_mapping)
+    {
+        if( !p_mapping ) return false;
+
+        const MappedFile* view = p_mapping.get();
+        ReadAt p_read_at = [view](uint64_t offset, void* dst, uint64_t size) -> uint64_t
+        {
+            if( offset >= view->size ) return 0;
+            size = std::min<uint64_t>(size, view->size - offset);
+            memcpy(dst, view->data() + offset, size);
+            return size;
+        };
+
+        if( !mount(p_read_at, p_mapping->size) ) return false;
+        mapping = std::move(p_mapping);
+        return true;
+    }
+
+    // reads (and checks) the index. returns false if this isn't an archive, or a broken one
+    bool mount(const ReadAt& p_read_at, uint64_t archive_size)
+    {
+        unmount();
+
+        Header header;
+        const Header expected;
+        if( p_read_at(0, &header, sizeof(header)) != sizeof(header) ) return false;
+        if( memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ) return false;
+
+        const uint64_t index_size = uint64_t(header.entry_count)*sizeof(Entry);
+        if( sizeof(Header) + index_size > archive_size || header.strings_offset + header.strings_size > archive_size ) return false;
+
+        std::vector<Entry> p_entries(header.entry_count);
+        std::string p_strings(header.strings_size, '\0');
+        if( p_read_at(sizeof(Header), p_entries.data(), index_size) != index_size ) return false;
+        if( p_read_at(header.strings_offset, p_strings.data(), header.strings_size) != header.strings_size ) return false;
+
+        for( const Entry& entry : p_entries )
+            if( entry.offset + entry.length > archive_size || uint64_t(entry.path_offset) + entry.path_length > p_strings.size() ) return false;
+
+        entries = std::move(p_entries);
+        strings = std::move(p_strings);
+
+        // (find() relies on this, and it's cheap to make sure of)
+        const bool sorted = std::is_sorted(entries.begin(), entries.end(), [this](const Entry& a, const Entry& b) { return path_of(a) < path_of(b); });
+        if( !sorted )
+        {
+            unmount();
+            return false;
+        }
+
+        read_at = p_read_at;
+        return true;
+    }
+
+    // drops every entry pred is true for, so that those files aren't found in the archive (and are opened on their
+    // own instead). returns how many were dropped
+    // NOTE: only while nothing is reading from the archive
+    size_t drop_if(const std::function<bool(const Entry&)>& pred)
+    {
+        const size_t count = entries.size();
+        entries.erase(std::remove_if(entries.begin(), entries.end(), pred), entries.end()); // (which keeps them sorted)
+        return count - entries.size();
+    }
+
+    // NOTE: only once nothing is reading from the archive anymore
+    void unmount()
+    {
+        entries.clear();
+        strings.clear();
+        mapping.reset();
+        read_at = nullptr;
+    }
+}; // AudioArchive
+
+} // rhythm
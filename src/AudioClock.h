@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+    AudioClock is a snapshot of where the audio thread is, published once per device period from
+    miniaudio's onProcess callback (see AudioEngine2::engine_process)
+
+    ma_engine_get_time_in_pcm_frames() only advances once per period, so anything polling it from the game
+    thread sees time move in steps of a whole buffer. AudioClock instead remembers *when* (on the host's
+    monotonic clock) the engine last reached a frame, and extrapolates forward from there using the sample rate
+
+    the snapshot is published with a seqlock: the audio thread never waits, and a reader that races a publish
+    simply tries again
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace rhythm
+{
+
+struct AudioClock
+{
+    struct Snapshot
+    {
+        int64_t engine_frame { -1 }; // ma_engine_get_time_in_pcm_frames() at the end of the last period
+        int64_t host_time_ns { 0 }; // steady_clock time that engine_frame was reached
+        int64_t period_in_frames { 0 }; // how many frames the last period rendered
+        int64_t sound_cursor { -1 }; // read cursor of the current track's ma_sound, or -1 if there is none
+    }; // Snapshot
+
+private:
+    std::atomic<uint32_t> sequence { 0 };
+    std::atomic<int64_t> engine_frame { -1 };
+    std::atomic<int64_t> host_time_ns { 0 };
+    std::atomic<int64_t> period_in_frames { 0 };
+    std::atomic<int64_t> sound_cursor { -1 };
+
+public:
+    uint32_t sample_rate { 48000 };
+
+    /* LEMMAS */
+
+    static int64_t host_now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    bool is_valid() const { return engine_frame.load(std::memory_order_relaxed) >= 0; }
+
+    Snapshot read() const
+    {
+        Snapshot snapshot;
+        uint32_t before, after;
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            if( before & 1 ) continue; // publish in progress
+
+            snapshot.engine_frame     = engine_frame.load(std::memory_order_relaxed);
+            snapshot.host_time_ns     = host_time_ns.load(std::memory_order_relaxed);
+            snapshot.period_in_frames = period_in_frames.load(std::memory_order_relaxed);
+            snapshot.sound_cursor     = sound_cursor.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while( (before & 1) || before != after );
+
+        return snapshot;
+    }
+
+    // the engine frame right now, extrapolated from the last snapshot
+    // never runs further ahead than one period, so a stalled or stopped device doesn't make time run away
+    int64_t now(const int64_t p_host_now_ns = host_now_ns()) const
+    {
+        const Snapshot snapshot = read();
+        if( snapshot.engine_frame < 0 ) return 0;
+
+        const int64_t elapsed_ns = std::clamp<int64_t>(p_host_now_ns - snapshot.host_time_ns, 0, 1000000000); // (clamped so this can't overflow)
+        const int64_t elapsed_frames = elapsed_ns * sample_rate / 1000000000;
+
+        return snapshot.engine_frame + std::min(elapsed_frames, snapshot.period_in_frames);
+    }
+
+    /* OPERATIONS */
+
+    // AUDIO THREAD ONLY!
+    void publish(const Snapshot& snapshot)
+    {
+        const uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        engine_frame.store(snapshot.engine_frame, std::memory_order_relaxed);
+        host_time_ns.store(snapshot.host_time_ns, std::memory_order_relaxed);
+        period_in_frames.store(snapshot.period_in_frames, std::memory_order_relaxed);
+        sound_cursor.store(snapshot.sound_cursor, std::memory_order_relaxed);
+
+        sequence.store(s + 2, std::memory_order_release);
+    }
+}; // AudioClock
+
+} // rhythm
@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    AudioMonitor measures the audio thread: how long every device period's callback takes (rendering the whole
+    engine), against how long it's allowed to take (the period's length in real time)
+
+    AudioEngine2 gives miniaudio its own device data callback (see AudioEngine2::device_data_callback) that times
+    ma_engine_read_pcm_frames() with begin() and end(). from that, per callback:
+        - load: duration / budget. over 100% means the callback took longer than the audio it made lasts
+        - an overrun: a callback over budget. enough of them in a row and the device runs dry
+        - jitter: how far the time since the last callback started is off from a period, either way. a steady device
+          calls back every period on the dot, so this is how unevenly the OS is scheduling us
+        - a late callback: one that started more than 1.5 periods after the last one. the device ran dry (or the
+          thread was starved) somewhere in between, so this is the closest thing to an xrun count miniaudio allows
+          (it doesn't report underruns itself)
+
+    the audio thread never waits or allocates: counters and the histograms are relaxed atomics, and every
+    callback is also pushed into a lock-free queue (dropped if the game thread isn't draining it), which drain()
+    collects into a history for graphs
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "dsp/spsc_queue.h"
+
+namespace rhythm
+{
+
+struct AudioMonitor
+{
+    struct Callback
+    {
+        int64_t start_ns { 0 }; // steady_clock
+        int64_t duration_ns { 0 };
+        int64_t interval_ns { 0 }; // since the last callback started (0 for the first)
+        int64_t jitter_ns { 0 }; // |interval - budget| (0 for the first)
+        uint32_t frames { 0 };
+        float load { 0.0f }; // duration / budget
+    }; // Callback
+
+    // 10% each (of load, or of a period of jitter), the last is everything from 100% up
+    static constexpr uint32_t histogram_buckets { 11 };
+    static constexpr uint32_t history_size { 512 }; // (callbacks)
+
+    /* STATE */
+
+    uint32_t sample_rate { 48000 };
+
+    // audio thread -> game thread
+    dsp::spsc_queue<Callback, 1024> callbacks;
+    std::atomic<uint64_t> callback_count { 0 };
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<uint64_t> late_callbacks { 0 };
+    std::atomic<uint64_t> dropped { 0 }; // (callbacks the queue had no room for)
+    std::atomic<int64_t> worst_duration_ns { 0 };
+    std::atomic<int64_t> worst_jitter_ns { 0 };
+    std::array<std::atomic<uint64_t>, histogram_buckets> load_histogram {};
+    std::array<std::atomic<uint64_t>, histogram_buckets> jitter_histogram {};
+
+    // owned by the audio thread
+    int64_t last_start_ns { 0 };
+
+    // owned by the game thread. the last history_size callbacks, oldest first from history_next
+    std::vector<Callback> history;
+    size_t history_next { 0 };
+    Callback last;
+
+    /* LEMMAS */
+
+    static int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    int64_t budget_ns(uint32_t frames) const { return int64_t(frames)*1000000000 / std::max<uint32_t>(sample_rate, 1); }
+
+    // GAME THREAD! calls f on every callback in history, oldest first
+    template<typename F>
+    void for_each(F&& f) const
+    {
+        for( size_t i = 0; i < history.size(); i++ ) f(history[(history_next + i) % history.size()]);
+    }
+
+    /* OPERATIONS */
+
+    // AUDIO THREAD! at the start of a callback. returns what end() needs
+    int64_t begin() const { return now_ns(); }
+
+    // AUDIO THREAD! at the end of a callback that rendered frames
+    void end(int64_t start_ns, uint32_t frames)
+    {
+        Callback callback;
+        callback.start_ns = start_ns;
+        callback.duration_ns = now_ns() - start_ns;
+        callback.interval_ns = ( last_start_ns > 0 ) ? start_ns - last_start_ns : 0;
+        callback.frames = frames;
+
+        const int64_t budget = budget_ns(frames);
+        callback.load = ( budget > 0 ) ? float(callback.duration_ns) / float(budget) : 0.0f;
+        last_start_ns = start_ns;
+
+        callback_count.fetch_add(1, std::memory_order_relaxed);
+        if( callback.duration_ns > budget ) overruns.fetch_add(1, std::memory_order_relaxed);
+        if( callback.interval_ns > budget + budget/2 ) late_callbacks.fetch_add(1, std::memory_order_relaxed);
+        if( callback.duration_ns > worst_duration_ns.load(std::memory_order_relaxed) ) worst_duration_ns.store(callback.duration_ns, std::memory_order_relaxed);
+
+        const uint32_t bucket = std::min<uint32_t>( static_cast<uint32_t>(callback.load*10.0f), histogram_buckets - 1 );
+        load_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        if( callback.interval_ns > 0 && budget > 0 )
+        {
+            callback.jitter_ns = std::abs(callback.interval_ns - budget);
+            if( callback.jitter_ns > worst_jitter_ns.load(std::memory_order_relaxed) ) worst_jitter_ns.store(callback.jitter_ns, std::memory_order_relaxed);
+
+            const uint32_t jitter_bucket = static_cast<uint32_t>( std::min<int64_t>(callback.jitter_ns*10 / budget, histogram_buckets - 1) );
+            jitter_histogram[jitter_bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if( !callbacks.push(callback) ) dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // GAME THREAD ONLY! moves every callback the audio thread has pushed into history
+    void drain()
+    {
+        if( history.size() != history_size ) history.assign(history_size, Callback{});
+
+        Callback callback;
+        while( callbacks.pop(callback) )
+        {
+            history[history_next] = callback;
+            history_next = (history_next + 1) % history.size();
+            last = callback;
+        }
+    }
+
+    // GAME THREAD ONLY! (the audio thread may still bump a counter it already loaded, which is fine for stats)
+    void reset()
+    {
+        drain();
+        callback_count.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        late_callbacks.store(0, std::memory_order_relaxed);
+        dropped.store(0, std::memory_order_relaxed);
+        worst_duration_ns.store(0, std::memory_order_relaxed);
+        worst_jitter_ns.store(0, std::memory_order_relaxed);
+        for( auto& bucket : load_histogram ) bucket.store(0, std::memory_order_relaxed);
+        for( auto& bucket : jitter_histogram ) bucket.store(0, std::memory_order_relaxed);
+        std::fill(history.begin(), history.end(), Callback{});
+        last = Callback{};
+    }
+}; // AudioMonitor
+
+} // rhythm
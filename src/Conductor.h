@@ -6,6 +6,7 @@
 #include <godot_cpp/classes/node.hpp>
 
 #include "Audio.h"
+#include "AudioClock.h"
 
 namespace rhythm
 {
@@ -21,6 +22,9 @@ struct Conductor
     
     godot::PackedInt64Array beats;
     int next_beat_index { 0 };
+
+    // set by AudioEngine2, used to interpolate the global current frame between device periods
+    const AudioClock* clock { nullptr };
     
     /* LEMMAS (known values that do not modify state) */
 
@@ -34,6 +38,9 @@ struct Conductor
         // otherwise we're paused, where we already know the frame we paused on (or we're at initial, which is frame 0)
         return pause_frame();
     }
+    // same as above, but with the global current frame interpolated by clock (see AudioClock.h)
+    int64_t get_local_current_frame() const { return get_local_current_frame( get_global_current_frame() ); }
+    int64_t get_global_current_frame() const { return clock ? clock->now() : 0; }
     int next_beat_search(int64_t local_frame) const
     {
         const int64_t* start = beats.ptr();
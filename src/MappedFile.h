@@ -0,0 +1,101 @@
+#pragma once
+
+/*
+    MappedFile is a read-only memory mapping of a whole file, unmapped when destroyed. the pages are shared with
+    the OS's file cache, so reading from a mapping is just reading memory (no syscall, no copy into a buffer)
+
+    used by PCMCache for decoded tracks, and by ma_vfs_mmap for audio files on the real filesystem
+*/
+
+#include <stdint.h>
+#include <filesystem>
+#include <memory>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace rhythm
+{
+
+struct MappedFile
+{
+    void* base { nullptr };
+    size_t size { 0 };
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(base); }
+
+    // maps the whole file. fails if it can't be opened, or is empty (since an empty file can't be mapped)
+    bool map(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if( file == INVALID_HANDLE_VALUE ) return false;
+
+        LARGE_INTEGER file_size;
+        if( !GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 )
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE file_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if( !file_mapping ) return false;
+
+        base = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(file_mapping); // (the view keeps the mapping alive)
+        if( !base ) return false;
+
+        size = static_cast<size_t>(file_size.QuadPart);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if( file < 0 ) return false;
+
+        struct stat info;
+        if( fstat(file, &info) != 0 || info.st_size == 0 )
+        {
+            ::close(file);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file); // (the mapping keeps the file alive)
+        if( view == MAP_FAILED ) return false;
+
+        base = view;
+        size = static_cast<size_t>(info.st_size);
+#endif
+
+        return true;
+    }
+
+    static std::unique_ptr<MappedFile> open(const std::filesystem::path& path)
+    {
+        std::unique_ptr<MappedFile> mapping = std::make_unique<MappedFile>();
+        return mapping->map(path) ? std::move(mapping) : nullptr;
+    }
+
+    ~MappedFile()
+    {
+        if( !base ) return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(base, size);
+#endif
+    }
+}; // MappedFile
+
+} // rhythm
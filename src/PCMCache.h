@@ -0,0 +1,196 @@
+#pragma once
+
+/*
+    PCMCache is an on-disk cache of fully decoded tracks, so that a track only ever has to be decoded once
+
+    each entry is a single raw file: a small Header, then the interleaved f32 PCM exactly as AsyncDecode
+    decoded it. a hit is memory-mapped and handed to miniaudio as-is (see AudioEngine2::DecodedAudio), so
+    re-opening a track costs an mmap rather than a decode, and the PCM is never copied
+
+    entries are keyed by the source file's path, size and modified time (plus the sample rate it was decoded
+    at), so an edited file or a different output device simply misses. least recently used entries (going
+    off of each file's modified time, which is touched on every hit) are evicted once the cache is over
+    max_size_in_bytes
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace rhythm
+{
+
+struct PCMCache
+{
+    // 64 bytes, so that the PCM after it stays nicely aligned
+    struct Header
+    {
+        char magic[4] { 'B', 'X', 'P', 'C' };
+        uint32_t version { 1 };
+        uint32_t channels { 0 };
+        uint32_t sample_rate { 0 };
+        uint64_t length_in_frames { 0 };
+        uint8_t reserved[40] {};
+    }; // Header
+    static_assert(sizeof(Header) == 64);
+
+    // a read-only view of one cache entry
+    struct Mapping : MappedFile
+    {
+        const Header& header() const { return *static_cast<const Header*>(base); }
+        const float* frames() const { return reinterpret_cast<const float*>( static_cast<const uint8_t*>(base) + sizeof(Header) ); }
+    }; // Mapping
+
+    /* STATE */
+
+    std::filesystem::path directory;
+    std::atomic<uint64_t> max_size_in_bytes { uint64_t(1024) << 20 };
+
+    /* LEMMAS */
+
+    // FNV-1a of everything that identifies a decode, as hex
+    static std::string key(const std::string& path, uint64_t size, uint64_t modified_time, uint32_t sample_rate)
+    {
+        const std::string identity = path + '\n' + std::to_string(size) + '\n' + std::to_string(modified_time) + '\n' + std::to_string(sample_rate);
+
+        uint64_t hash = 14695981039346656037ull;
+        for( const char c : identity )
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+        return hex;
+    }
+
+    std::filesystem::path entry_path(const std::string& key) const { return directory / (key + ".pcm"); }
+
+    /* OPERATIONS */
+
+    // maps the entry for key, or returns nullptr on a miss (or a corrupt entry, which is deleted)
+    std::unique_ptr<Mapping> open(const std::string& key) const
+    {
+        if( directory.empty() ) return nullptr;
+
+        const std::filesystem::path path = entry_path(key);
+        std::unique_ptr<Mapping> mapping = map(path);
+        if( !mapping ) return nullptr;
+
+        const Header& header = mapping->header();
+        const Header expected;
+        const bool valid = mapping->size >= sizeof(Header)
+            && memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+            && header.version == expected.version
+            && header.channels > 0
+            && mapping->size == sizeof(Header) + header.length_in_frames*header.channels*sizeof(float);
+        if( !valid )
+        {
+            mapping.reset();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            return nullptr;
+        }
+
+        // touch, so that eviction knows this one was used recently
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+        return mapping;
+    }
+
+    // writes an entry for key, then evicts down to max_size_in_bytes. safe to call from any thread
+    bool store(const std::string& key, uint32_t channels, uint32_t sample_rate, const float* pcm, uint64_t length_in_frames) const
+    {
+        if( directory.empty() ) return false;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        // write to a temporary first, so that a half-written entry is never mistaken for a real one
+        const std::filesystem::path path = entry_path(key);
+        std::filesystem::path temporary_path = path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            if( !file ) return false;
+
+            Header header;
+            header.channels = channels;
+            header.sample_rate = sample_rate;
+            header.length_in_frames = length_in_frames;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(pcm), static_cast<std::streamsize>( length_in_frames*channels*sizeof(float) ));
+            if( !file ) return false;
+        }
+
+        std::filesystem::rename(temporary_path, path, error);
+        if( error )
+        {
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+
+        evict();
+        return true;
+    }
+
+    // deletes least recently used entries until the cache fits in max_size_in_bytes
+    void evict() const
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type last_used;
+            uint64_t size;
+        }; // Entry
+
+        std::vector<Entry> entries;
+        uint64_t total_size = 0;
+
+        std::error_code error;
+        for( std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error) )
+        {
+            if( it->path().extension() != ".pcm" ) continue;
+
+            Entry entry { it->path(), it->last_write_time(error), it->file_size(error) };
+            if( error ) { error.clear(); continue; }
+
+            total_size += entry.size;
+            entries.push_back(std::move(entry));
+        }
+
+        const uint64_t max_size = max_size_in_bytes.load(std::memory_order_relaxed);
+        if( total_size <= max_size ) return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.last_used < b.last_used; });
+        for( const Entry& entry : entries )
+        {
+            if( total_size <= max_size ) break;
+
+            // (an entry that is still mapped stays readable after being removed, since its mapping holds on to the file)
+            if( std::filesystem::remove(entry.path, error) ) total_size -= entry.size;
+        }
+    }
+
+private:
+    static std::unique_ptr<Mapping> map(const std::filesystem::path& path)
+    {
+        std::unique_ptr<Mapping> mapping = std::make_unique<Mapping>();
+        return mapping->map(path) ? std::move(mapping) : nullptr;
+    }
+}; // PCMCache
+
+} // rhythm
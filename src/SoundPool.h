@@ -0,0 +1,241 @@
+#pragma once
+
+/*
+    SoundPool owns every ma_sound that AudioEngine2 loads. sounds live in fixed-size slabs (an ma_sound is
+    part of miniaudio's node graph, so it can never be moved once initialized), and freed slots are reused
+
+    instead of a raw pointer or index, an Audio holds a SoundHandle: a slot index plus the generation of the
+    slot when it was handed out. releasing a slot bumps its generation, so a handle to an unloaded sound
+    simply stops resolving (get() returns nullptr) rather than dangling, or worse, pointing at whatever
+    sound reused the slot
+
+    the pool is bounded by a memory budget and a maximum sound count. evict() unloads the least recently
+    touched sounds until it's back under both, skipping anything the caller says is pinned
+*/
+
+#include <stdint.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "miniaudio.h"
+
+#include "PCMCache.h"
+
+namespace rhythm
+{
+
+struct SoundHandle
+{
+    static constexpr uint32_t none { UINT32_MAX };
+
+    uint32_t index { none };
+    uint32_t generation { 0 };
+
+    bool operator==(const SoundHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SoundHandle& other) const { return !(*this == other); }
+}; // SoundHandle
+
+// the PCM (and the ma_audio_buffer around it) behind a sound that was swapped to its decoded version
+struct DecodedAudio
+{
+    // the PCM is in one of these: either decoded into memory, or mapped from the pcm cache
+    std::vector<float> pcm;
+    std::unique_ptr<PCMCache::Mapping> mapping;
+    ma_audio_buffer buffer;
+    bool initialized { false };
+
+    uint64_t size_in_bytes() const { return mapping ? mapping->size : pcm.size()*sizeof(float); }
+
+    ~DecodedAudio() { if( initialized ) ma_audio_buffer_uninit(&buffer); }
+}; // DecodedAudio
+
+struct SoundPool
+{
+    struct Slot
+    {
+        ma_sound sound;
+        std::unique_ptr<DecodedAudio> decoded; // (nullptr if the sound was loaded through the resource manager)
+        std::string name; // just for logging
+
+        uint32_t generation { 0 };
+        bool used { false };
+        bool initialized { false }; // whether sound needs ma_sound_uninit
+        uint64_t last_used { 0 };
+    }; // Slot
+
+    // what a sound costs while the resource manager hasn't said yet (it's still loading), and what a stream (two
+    // pages of PCM, of a second each, plus its decoder) is counted as
+    static constexpr uint64_t streamed_size_in_bytes { 1 << 20 };
+    static constexpr size_t slab_size { 32 };
+
+private:
+    std::vector<std::unique_ptr<std::array<Slot, slab_size>>> slabs;
+    std::vector<uint32_t> free_slots;
+    uint64_t tick { 0 };
+
+    Slot& at(uint32_t index) { return (*slabs[index / slab_size])[index % slab_size]; }
+    const Slot& at(uint32_t index) const { return (*slabs[index / slab_size])[index % slab_size]; }
+
+    // what the resource manager holds for a sound loaded from a file: the whole encoded file for a plain data
+    // buffer, all of its PCM for one loaded with MA_SOUND_FLAG_DECODE, or a couple of pages for a stream
+    static uint64_t resource_size_in_bytes(const ma_sound& sound)
+    {
+        ma_resource_manager_data_source* source = sound.pResourceManagerDataSource;
+        if( !source || (source->flags & MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_STREAM) ) return streamed_size_in_bytes;
+
+        // the job thread writes the supply while it's loading, so it's only read once the result (an atomic, stored
+        // after it) says it's done. until then, it's charged like a stream
+        if( ma_resource_manager_data_source_result(source) != MA_SUCCESS ) return streamed_size_in_bytes;
+
+        const ma_resource_manager_data_buffer_node* node = source->backend.buffer.pNode;
+        if( !node ) return streamed_size_in_bytes;
+
+        const ma_resource_manager_data_supply& supply = node->data;
+        switch( static_cast<ma_resource_manager_data_supply_type>(supply.type) )
+        {
+            case ma_resource_manager_data_supply_type_encoded:
+                return supply.backend.encoded.sizeInBytes;
+            case ma_resource_manager_data_supply_type_decoded:
+                return supply.backend.decoded.totalFrameCount * ma_get_bytes_per_frame(supply.backend.decoded.format, supply.backend.decoded.channels);
+            case ma_resource_manager_data_supply_type_decoded_paged:
+                return supply.backend.decodedPaged.decodedFrameCount * ma_get_bytes_per_frame(supply.backend.decodedPaged.data.format, supply.backend.decodedPaged.data.channels);
+            default:
+                return streamed_size_in_bytes;
+        }
+    }
+
+    static uint64_t size_in_bytes(const Slot& slot)
+    {
+        if( slot.decoded ) return slot.decoded->size_in_bytes();
+        return slot.initialized ? resource_size_in_bytes(slot.sound) : 0;
+    }
+
+public:
+    /* STATE */
+
+    uint64_t budget_in_bytes { uint64_t(512) << 20 };
+    size_t max_sounds { 128 };
+
+    /* LEMMAS */
+
+    Slot* slot(const SoundHandle& handle)
+    {
+        if( handle.index == SoundHandle::none || handle.index >= slabs.size()*slab_size ) return nullptr;
+
+        Slot& slot = at(handle.index);
+        return ( slot.used && slot.generation == handle.generation ) ? &slot : nullptr;
+    }
+    const Slot* slot(const SoundHandle& handle) const { return const_cast<SoundPool*>(this)->slot(handle); }
+
+    // (the pool owns the sound, but whoever holds a handle is free to play, seek, etc. it)
+    ma_sound* get(const SoundHandle& handle) const
+    {
+        const Slot* s = slot(handle);
+        return ( s && s->initialized ) ? const_cast<ma_sound*>(&s->sound) : nullptr;
+    }
+    bool is_loaded(const SoundHandle& handle) const { const Slot* s = slot(handle); return s && s->initialized; }
+    bool is_decoded(const SoundHandle& handle) const { const Slot* s = slot(handle); return s && s->decoded; }
+
+    size_t used_count() const { return slabs.size()*slab_size - free_slots.size(); }
+    uint64_t used_size_in_bytes() const
+    {
+        uint64_t total = 0;
+        for( uint32_t i = 0; i < slabs.size()*slab_size; i++ )
+            if( at(i).used ) total += size_in_bytes(at(i));
+        return total;
+    }
+
+    /* OPERATIONS */
+
+    // hands out an unused slot. initialize its sound, then mark it initialized (or release() it if that failed)
+    SoundHandle acquire(const std::string& name)
+    {
+        if( free_slots.empty() )
+        {
+            const uint32_t first = static_cast<uint32_t>( slabs.size()*slab_size );
+            slabs.push_back(std::make_unique<std::array<Slot, slab_size>>());
+
+            // (pushed in reverse, so that slots are handed out lowest index first)
+            for( uint32_t i = slab_size; i > 0; i-- ) free_slots.push_back(first + i - 1);
+        }
+
+        const uint32_t index = free_slots.back();
+        free_slots.pop_back();
+
+        Slot& slot = at(index);
+        slot.used = true;
+        slot.initialized = false;
+        slot.name = name;
+        slot.last_used = ++tick;
+
+        return { index, slot.generation };
+    }
+
+    void touch(const SoundHandle& handle) { if( Slot* s = slot(handle) ) s->last_used = ++tick; }
+
+    // unloads the sound (if there is one) and frees its slot. every handle to it is now stale
+    void release(const SoundHandle& handle)
+    {
+        Slot* s = slot(handle);
+        if( !s ) return;
+
+        if( s->initialized ) ma_sound_uninit(&s->sound); // (detaches from the graph first, so the audio thread is done with it)
+        s->decoded.reset();
+        s->name.clear();
+        s->initialized = false;
+        s->used = false;
+        s->generation++;
+
+        free_slots.push_back(handle.index);
+    }
+
+    // unloads least recently used sounds until the pool fits its budget and max_sounds. returns how many it unloaded
+    size_t evict(const std::function<bool(const SoundHandle&)>& is_pinned)
+    {
+        std::vector<SoundHandle> candidates;
+        uint64_t total_size = 0;
+        size_t total_count = 0;
+
+        for( uint32_t i = 0; i < slabs.size()*slab_size; i++ )
+        {
+            const Slot& s = at(i);
+            if( !s.used ) continue;
+
+            total_size += size_in_bytes(s);
+            total_count++;
+
+            const SoundHandle handle { i, s.generation };
+            if( !is_pinned(handle) ) candidates.push_back(handle);
+        }
+
+        if( total_size <= budget_in_bytes && total_count <= max_sounds ) return 0;
+
+        std::sort(candidates.begin(), candidates.end(), [this](const SoundHandle& a, const SoundHandle& b) { return at(a.index).last_used < at(b.index).last_used; });
+
+        size_t evicted = 0;
+        for( const SoundHandle& handle : candidates )
+        {
+            if( total_size <= budget_in_bytes && total_count <= max_sounds ) break;
+
+            total_size -= size_in_bytes(at(handle.index));
+            total_count--;
+
+            release(handle);
+            evicted++;
+        }
+
+        return evicted;
+    }
+
+    void clear()
+    {
+        for( uint32_t i = 0; i < slabs.size()*slab_size; i++ )
+            if( at(i).used ) release({ i, at(i).generation });
+    }
+}; // SoundPool
+
+} // rhythm
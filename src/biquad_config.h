@@ -10,6 +10,8 @@
     lazy solution, but it works
     
     biquad_config also contains a Type enum and a corresponding type_to_string function
+
+    (no godot in here, so the dsp nodes build without it, eg. in bench/)
 */
 
 #include "miniaudio.h"
@@ -17,8 +19,6 @@
 #include <cassert>
 #include <cmath>
 
-#include <godot_cpp/variant/string.hpp>
-
 #define MA_PI_D M_PI
 #define MA_ASSERT assert
 #define ma_sind std::sin
@@ -29,7 +29,7 @@
 namespace rhythm::dsp::bqcfg
 {
     enum struct Type : int32_t { biquad = 0, lpf2 = 1, hpf2 = 2, bpf2 = 3, notch2 = 4, peak2 = 5, loshelf2 = 6, hishelf2 = 7 };
-    godot::String type_to_string(const Type type)
+    inline const char* type_to_string(const Type type)
     {
         switch( type )
         {
@@ -42,9 +42,10 @@ namespace rhythm::dsp::bqcfg
             case Type::loshelf2: return "low shelf filter";
             case Type::hishelf2: return "high shelf filter";
         }
+        return "unknown filter";
     }
 
-    ma_biquad_config lpf2(const ma_lpf2_config* pConfig)
+    inline ma_biquad_config lpf2(const ma_lpf2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double q;
@@ -74,7 +75,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config hpf2(const ma_hpf2_config* pConfig)
+    inline ma_biquad_config hpf2(const ma_hpf2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double q;
@@ -104,7 +105,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config bpf2(const ma_bpf2_config* pConfig)
+    inline ma_biquad_config bpf2(const ma_bpf2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double q;
@@ -134,7 +135,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config notch2(const ma_notch2_config* pConfig)
+    inline ma_biquad_config notch2(const ma_notch2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double q;
@@ -164,7 +165,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config peak2(const ma_peak2_config* pConfig)
+    inline ma_biquad_config peak2(const ma_peak2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double q;
@@ -196,7 +197,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config loshelf2(const ma_loshelf2_config* pConfig)
+    inline ma_biquad_config loshelf2(const ma_loshelf2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double w;
@@ -230,7 +231,7 @@ namespace rhythm::dsp::bqcfg
         return bqConfig;
     }
 
-    ma_biquad_config hishelf2(const ma_hishelf2_config* pConfig)
+    inline ma_biquad_config hishelf2(const ma_hishelf2_config* pConfig)
     {
         ma_biquad_config bqConfig;
         double w;
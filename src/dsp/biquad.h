@@ -0,0 +1,145 @@
+#pragma once
+
+/*
+    biquad_cascade runs up to max_stages identical 2nd order sections in series (so 12dB/octave per stage for a
+    low/high pass), in transposed direct form II:
+
+        y  = b0*x + s1
+        s1 = b1*x - a1*y + s2
+        s2 = b2*x - a2*y
+
+    every frame depends on the last, so instead of vectorizing over time it's vectorized over channels: each f32x4
+    holds the same frame of 4 channels (so stereo is one step per frame per stage, with 2 lanes idle), see simd.h
+
+    coefficients are normalized by a0, like ma_biquad does. they're computed off the audio thread (see eg.
+    biquad_config.h for miniaudio's filters) and just handed to process(). to glide from one set to another without
+    recomputing them, coefficients::lerp blends the two (see FilterNode)
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "miniaudio.h"
+
+#include "simd.h"
+
+namespace rhythm::dsp
+{
+
+struct biquad_cascade
+{
+    static constexpr uint32_t max_stages { 4 };
+
+    struct coefficients
+    {
+        float b0 { 1.0f }, b1 { 0.0f }, b2 { 0.0f }, a1 { 0.0f }, a2 { 0.0f };
+        uint32_t stages { 1 };
+
+        static coefficients from(const ma_biquad_config& config, uint32_t stages)
+        {
+            const double a0 = config.a0;
+            return {
+                static_cast<float>(config.b0 / a0), static_cast<float>(config.b1 / a0), static_cast<float>(config.b2 / a0),
+                static_cast<float>(config.a1 / a0), static_cast<float>(config.a2 / a0),
+                std::clamp<uint32_t>(stages, 1, max_stages)
+            };
+        }
+
+        // t of the way from a to b (with b's stages). a section is stable as long as |a2| < 1 and |a1| < 1 + a2,
+        // which is a triangle, so anything between two stable sets is stable too
+        static coefficients lerp(const coefficients& a, const coefficients& b, float t)
+        {
+            return {
+                a.b0 + (b.b0 - a.b0)*t, a.b1 + (b.b1 - a.b1)*t, a.b2 + (b.b2 - a.b2)*t,
+                a.a1 + (b.a1 - a.a1)*t, a.a2 + (b.a2 - a.a2)*t,
+                b.stages
+            };
+        }
+    }; // coefficients
+
+    /* STATE */
+
+    uint32_t channels { 0 };
+    uint32_t groups { 0 }; // (of 4 channels)
+    std::vector<simd::f32x4> state; // [stage][group] { s1, s2 }
+
+    /* OPERATIONS */
+
+    void init(uint32_t p_channels)
+    {
+        channels = p_channels;
+        groups = (channels + 3) / 4;
+        state.assign(size_t(max_stages)*groups*2, simd::set1(0.0f));
+    }
+
+    void reset() { std::fill(state.begin(), state.end(), simd::set1(0.0f)); }
+
+    // silences stages [first, last), eg. ones that are about to be switched back on, and would otherwise pick up
+    // from whatever they were in the middle of when they were switched off
+    void reset_stages(uint32_t first, uint32_t last)
+    {
+        first = std::min(first, max_stages);
+        last = std::min(last, max_stages);
+        if( first < last ) std::fill(state.begin() + size_t(first)*groups*2, state.begin() + size_t(last)*groups*2, simd::set1(0.0f));
+    }
+
+    // filters frame_count frames of in (interleaved, `channels` channels) into out. in may be nullptr for silence
+    // (so the filter still rings out), and may be out
+    void process(const coefficients& c, const float* in, float* out, uint32_t frame_count)
+    {
+        using namespace simd;
+
+        const f32x4 b0 = set1(c.b0), b1 = set1(c.b1), b2 = set1(c.b2), a1 = set1(c.a1), a2 = set1(c.a2);
+        const uint32_t stages = std::clamp<uint32_t>(c.stages, 1, max_stages);
+
+        for( uint32_t g = 0; g < groups; g++ )
+        {
+            const uint32_t first_channel = g*4;
+            const uint32_t lanes = std::min<uint32_t>(4, channels - first_channel);
+
+            // (the state stays in registers for the whole block)
+            f32x4 s1[max_stages], s2[max_stages];
+            for( uint32_t s = 0; s < stages; s++ )
+            {
+                s1[s] = state[(size_t(s)*groups + g)*2];
+                s2[s] = state[(size_t(s)*groups + g)*2 + 1];
+            }
+
+            for( uint32_t f = 0; f < frame_count; f++ )
+            {
+                const size_t offset = size_t(f)*channels + first_channel;
+
+                f32x4 x = set1(0.0f);
+                if( in ) x = ( lanes == 4 ) ? load(in + offset) : load_strided(in + offset, 1, lanes);
+
+                for( uint32_t s = 0; s < stages; s++ )
+                {
+                    const f32x4 y = mul_add(b0, x, s1[s]);
+                    s1[s] = mul_add(b1, x, s2[s]) - a1*y;
+                    s2[s] = b2*x - a2*y;
+                    x = y;
+                }
+
+                if( lanes == 4 ) store(out + offset, x);
+                else
+                {
+                    float lane[4];
+                    store(lane, x);
+                    memcpy(out + offset, lane, sizeof(float)*lanes);
+                }
+            }
+
+            // (a tail ringing out into denormals would get very slow, so anything that small is just 0)
+            const f32x4 tiny = set1(1e-15f), zero = set1(0.0f);
+            for( uint32_t s = 0; s < stages; s++ )
+            {
+                state[(size_t(s)*groups + g)*2] = select(abs(s1[s]) < tiny, zero, s1[s]);
+                state[(size_t(s)*groups + g)*2 + 1] = select(abs(s2[s]) < tiny, zero, s2[s]);
+            }
+        }
+    }
+}; // biquad_cascade
+
+} // rhythm::dsp
@@ -0,0 +1,229 @@
+#pragma once
+
+/*
+    FilterNode runs any of miniaudio's 2nd order filters (see biquad_config.h), cascaded up to 4 times
+
+    the coefficients are computed on the game thread whenever a setting changes, and handed to the audio thread
+    the same way click_node gets new schedules (see ma_click_node.h): published through `pending`, with the ones
+    they replace handed back through `retired`. those are kept as the spare for the next update rather than freed,
+    so that dragging a slider doesn't allocate every frame
+
+    the audio thread never computes coefficients, but it doesn't jump to new ones either (which zippers): it glides
+    from whatever it was running to them over ramp_seconds, blending the two (see coefficients::lerp) every
+    coefficient_interval frames. the number of stages can't glide, so it changes straight away, and any stages that
+    get switched on start out silent
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+
+#include "miniaudio.h"
+
+#include "biquad_config.h"
+#include "biquad.h"
+#include "node.h"
+
+namespace rhythm::dsp
+{
+
+struct FilterNode : public DSPNode
+{
+    using coefficients = biquad_cascade::coefficients;
+
+    static constexpr float ramp_seconds { 0.02f };
+    // how often the blend moves along while gliding (short enough that each step is inaudible)
+    static constexpr uint32_t coefficient_interval { 32 };
+
+    /* STATE */
+
+    // game thread
+    bqcfg::Type type { bqcfg::Type::lpf2 };
+    double cutoff { 1000.0 }; // (or center frequency)
+    double q { 0.707107 }; // (or shelf slope)
+    double gain_db { 0.0 }; // (peak and shelves only)
+    uint32_t stages { 1 };
+    ma_uint32 sample_rate { 48000 };
+
+    // game thread -> audio thread
+    std::atomic<coefficients*> pending { nullptr };
+    // audio thread -> game thread
+    std::atomic<coefficients*> retired { nullptr };
+    // game thread, for the next update() to fill in
+    coefficients* spare { nullptr };
+
+    // owned by the audio thread
+    coefficients* active { nullptr }; // (what it's gliding to, or at)
+    coefficients current; // (what the cascade is running with right now)
+    coefficients from;
+    uint32_t ramp_frames { 960 };
+    uint32_t ramp_remaining { 0 };
+    biquad_cascade cascade;
+
+    ~FilterNode() override
+    {
+        delete pending.exchange(nullptr);
+        delete retired.exchange(nullptr);
+        delete spare;
+        delete active;
+    }
+
+    ma_result init(ma_engine* p_engine) override
+    {
+        sample_rate = ma_engine_get_sample_rate(p_engine);
+        ramp_frames = std::max<uint32_t>(1, static_cast<uint32_t>( ramp_seconds*sample_rate ));
+        cascade.init(ma_engine_get_channels(p_engine));
+        update();
+        spare = new coefficients; // (so the first change after this doesn't allocate either)
+
+        return MA_SUCCESS;
+    }
+
+    uint32_t get_input_count() const override { return 1; }
+
+    void process(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count) override
+    {
+        // adopt new coefficients, but only once the game thread has collected the last ones we retired
+        if( retired.load(std::memory_order_acquire) == nullptr )
+        {
+            coefficients* c = pending.exchange(nullptr, std::memory_order_acq_rel);
+            if( c )
+            {
+                retired.store(active, std::memory_order_release);
+                adopt(c);
+            }
+        }
+
+        if( !active || channels != cascade.channels )
+        {
+            if( inputs[0] ) memcpy(out, inputs[0], sizeof(float)*frame_count*channels);
+            else memset(out, 0, sizeof(float)*frame_count*channels);
+            return;
+        }
+
+        if( ramp_remaining == 0 )
+        {
+            cascade.process(current, inputs[0], out, frame_count);
+            return;
+        }
+
+        const float* in = inputs[0];
+        for( uint32_t start = 0; start < frame_count; start += coefficient_interval )
+        {
+            const uint32_t count = std::min(coefficient_interval, frame_count - start);
+
+            // (each chunk runs with the blend as of its end, so the last one lands exactly on active)
+            ramp_remaining -= std::min(ramp_remaining, count);
+            current = ( ramp_remaining == 0 ) ? *active : coefficients::lerp(from, *active, 1.0f - float(ramp_remaining) / ramp_frames);
+
+            cascade.process(current, in ? in + size_t(start)*channels : nullptr, out + size_t(start)*channels, count);
+        }
+    }
+
+    // AUDIO THREAD! starts gliding to c, from wherever the last glide got to
+    void adopt(coefficients* c)
+    {
+        const bool first = ( active == nullptr );
+        active = c;
+        if( first )
+        {
+            // (nothing to glide from, and the cascade starts out silent)
+            current = *c;
+            ramp_remaining = 0;
+            return;
+        }
+
+        if( c->stages > current.stages ) cascade.reset_stages(current.stages, c->stages);
+        from = current;
+        from.stages = current.stages = c->stages;
+        ramp_remaining = ramp_frames;
+    }
+
+    /* OPERATIONS */
+
+    // GAME THREAD ONLY! takes back whatever coefficients the audio thread has finished with, as the spare
+    void collect()
+    {
+        coefficients* c = retired.exchange(nullptr, std::memory_order_acquire);
+        if( !c ) return;
+        delete spare;
+        spare = c;
+    }
+
+    // GAME THREAD ONLY! recomputes the coefficients from the settings, and hands them to the audio thread
+    void update()
+    {
+        collect();
+
+        // (the formulas break down at and past nyquist, and at q = 0)
+        const double frequency = std::clamp(cutoff, 1.0, 0.49*sample_rate);
+        const double safe_q = std::max(q, 0.01);
+
+        ma_biquad_config config;
+        switch( type )
+        {
+            case bqcfg::Type::hpf2:
+            {
+                ma_hpf2_config c = ma_hpf2_config_init(ma_format_f32, cascade.channels, sample_rate, frequency, safe_q);
+                config = bqcfg::hpf2(&c);
+                break;
+            }
+            case bqcfg::Type::bpf2:
+            {
+                ma_bpf2_config c = ma_bpf2_config_init(ma_format_f32, cascade.channels, sample_rate, frequency, safe_q);
+                config = bqcfg::bpf2(&c);
+                break;
+            }
+            case bqcfg::Type::notch2:
+            {
+                ma_notch2_config c = ma_notch2_config_init(ma_format_f32, cascade.channels, sample_rate, safe_q, frequency);
+                config = bqcfg::notch2(&c);
+                break;
+            }
+            case bqcfg::Type::peak2:
+            {
+                ma_peak2_config c = ma_peak2_config_init(ma_format_f32, cascade.channels, sample_rate, gain_db, safe_q, frequency);
+                config = bqcfg::peak2(&c);
+                break;
+            }
+            case bqcfg::Type::loshelf2:
+            {
+                ma_loshelf2_config c = ma_loshelf2_config_init(ma_format_f32, cascade.channels, sample_rate, gain_db, safe_q, frequency);
+                config = bqcfg::loshelf2(&c);
+                break;
+            }
+            case bqcfg::Type::hishelf2:
+            {
+                ma_hishelf2_config c = ma_hishelf2_config_init(ma_format_f32, cascade.channels, sample_rate, gain_db, safe_q, frequency);
+                config = bqcfg::hishelf2(&c);
+                break;
+            }
+            case bqcfg::Type::lpf2:
+            default:
+            {
+                ma_lpf2_config c = ma_lpf2_config_init(ma_format_f32, cascade.channels, sample_rate, frequency, safe_q);
+                config = bqcfg::lpf2(&c);
+                break;
+            }
+        }
+
+        // (reusing the last ones if the audio thread never took them, and the spare otherwise)
+        coefficients* c = pending.exchange(nullptr, std::memory_order_acq_rel);
+        if( !c )
+        {
+            c = spare ? spare : new coefficients;
+            spare = nullptr;
+        }
+        *c = coefficients::from(config, stages);
+        pending.store(c, std::memory_order_release);
+    }
+
+    void set_type(int p_type) { type = (bqcfg::Type)p_type; update(); }
+    void set_cutoff(double p_cutoff) { cutoff = p_cutoff; update(); }
+    void set_q(double p_q) { q = p_q; update(); }
+    void set_gain_db(double p_gain_db) { gain_db = p_gain_db; update(); }
+    void set_stages(int p_stages) { stages = static_cast<uint32_t>( std::clamp<int>(p_stages, 1, biquad_cascade::max_stages) ); update(); }
+}; // FilterNode
+
+} // rhythm::dsp
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+    MultiplierNode multiplies input 0 (plus input 1, if it's connected) by its multiplier
+*/
+
+#include <stdint.h>
+
+#include "miniaudio.h"
+
+#include "node.h"
+#include "parameter.h"
+
+namespace rhythm::dsp
+{
+
+struct MultiplierNode : public DSPNode
+{
+    dsp::parameter multiplier { 100.0f };
+    
+    ma_result init(ma_engine* p_engine) override
+    {
+        multiplier.sample_rate = static_cast<float>( ma_engine_get_sample_rate(p_engine) );
+        return MA_SUCCESS;
+    }
+    
+    uint32_t get_input_count() const override { return 2; } // in, multiplier in
+    
+    void process(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count) override
+    {
+        const float* in = inputs[0];
+        const float* multiplier_in = inputs[1];
+        
+        const dsp::Gain current_multiplier = advance_gain(frame_count);
+        
+        if( !current_multiplier.frames )
+        {
+            const float m = current_multiplier.value;
+            const uint32_t samples = frame_count*channels;
+            
+            if( in && multiplier_in )
+                for( uint32_t i = 0; i < samples; i++ )
+                    out[i] = (in[i] + multiplier_in[i]) * m;
+            else if( in )
+                for( uint32_t i = 0; i < samples; i++ )
+                    out[i] = in[i] * m;
+            else
+                for( uint32_t i = 0; i < samples; i++ )
+                    out[i] = 0;
+            return;
+        }
+        
+        // (ramping)
+        for( uint32_t f = 0; f < frame_count; f++ )
+        {
+            const float m = current_multiplier.frames[f];
+            for( uint32_t c = 0; c < channels; c++ )
+            {
+                const uint32_t i = f*channels + c;
+                out[i] = in ? (in[i] + (multiplier_in ? multiplier_in[i] : 0.0f)) * m : 0.0f;
+            }
+        }
+    }
+    
+    // with only input 0 connected, we're just a gain (see Plan::compile)
+    bool is_gain() const override { return true; }
+    dsp::Gain advance_gain(uint32_t frame_count) override
+    {
+        const float* frames = multiplier.advance(frame_count);
+        return { multiplier.value, frames };
+    }
+    
+    void set_multiplier(const double p_multiplier)
+    {
+        multiplier.set( static_cast<float>(p_multiplier) );
+    }
+}; // MultiplierNode
+
+} // rhythm::dsp
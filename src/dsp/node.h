@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "miniaudio.h"
+
+namespace rhythm::dsp
+{
+
+// process() is never called with more frames than this (see Plan::run)
+static constexpr uint32_t max_block_frames { 512 };
+
+// a gain for process_with_gain(): a constant, or one value per frame while it's ramping
+struct Gain
+{
+    float value { 1.0f };
+    const float* frames { nullptr };
+
+    float at(uint32_t frame) const { return frames ? frames[frame] : value; }
+}; // Gain
+
+/*
+    DSPNode is one node of the user's dsp graph. it doesn't know about its connections, or about miniaudio's node
+    graph: a compiled Plan (see plan.h) decides the order nodes run in and which buffers they read and write, and
+    calls process() on the audio thread
+
+    every buffer is interleaved f32 with the engine's channel count. an input that isn't connected is nullptr
+*/
+struct DSPNode
+{
+    virtual ~DSPNode() = default;
+    virtual ma_result init(ma_engine* p_engine) = 0;
+
+    virtual uint32_t get_input_count() const { return 0; }
+    virtual uint32_t get_output_count() const { return 1; }
+
+    // AUDIO THREAD! renders frame_count frames into out
+    virtual void process(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count) = 0;
+
+    // AUDIO THREAD! for parameters that can't just be atomics. sent from the game thread with plan_node::set_parameter
+    virtual void set_parameter(uint32_t parameter, float value) {}
+
+    /* FUSING */
+
+    // a node that can scale its own output for free can be fused with a gain node after it (see Plan::compile)
+    virtual bool can_process_with_gain() const { return false; }
+    virtual void process_with_gain(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count, Gain gain) {}
+
+    // whether this node is just a gain on input 0 whenever nothing else is connected to it
+    virtual bool is_gain() const { return false; }
+    // AUDIO THREAD! the gain for the next frame_count frames (moving any ramp along), for when this node is fused
+    virtual Gain advance_gain(uint32_t frame_count) { return {}; }
+}; // DSPNode
+
+} // rhythm::dsp
@@ -0,0 +1,156 @@
+#pragma once
+
+/*
+    oscillator renders one of miniaudio's waveforms (sine, square, triangle, sawtooth) a block at a time, 4 frames
+    per step (see simd.h), with optional audio-rate frequency and amplitude modulation
+
+    the phase of each frame in a step is the phase before it plus an (exclusive) prefix sum of each frame's
+    increment, so modulation is exact per frame, exactly like calling ma_waveform_set_frequency() before every
+    ma_waveform_read_pcm_frames(..., 1, ...) would be, minus the per frame function calls and double math
+
+    waveforms match ma_waveform's (same phase, same shapes), except that the phase wraps with floor() instead of
+    truncating, so a negative frequency runs the waveform backwards instead of folding it
+
+    by default, square, triangle and sawtooth play from the band-limited tables in wavetable.h, so they don't
+    alias. the sine is computed directly, since it's already band-limited (and that's cheaper than a lookup)
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+#include "miniaudio.h"
+
+#include "simd.h"
+#include "wavetable.h"
+
+namespace rhythm::dsp
+{
+
+struct oscillator
+{
+    /* STATE */
+
+    double phase { 0.0 }; // [0, 1). (double, so that it doesn't drift. each step only needs float offsets from it)
+    float sample_rate { 48000.0f };
+    bool band_limited { true }; // (false for ma_waveform's naive shapes)
+
+    /* OPERATIONS */
+
+    /*
+        renders frame_count frames into out (interleaved, out_channels channels, every channel the same)
+
+        frequency_in and amplitude_in are optional (nullptr for none) modulation, interleaved with in_channels
+        channels, of which only the first is read. a frame's frequency is frequency + frequency_in, and its
+        amplitude is amplitude*(1 + amplitude_in)
+
+        frequency_frames and amplitude_frames are optional (nullptr for none) per frame replacements for frequency
+        and amplitude (one float per frame), eg. while a parameter ramps (see parameter.h)
+    */
+    void process(ma_waveform_type type, float frequency, float amplitude, const float* frequency_in, const float* amplitude_in, uint32_t in_channels, float* out, uint32_t out_channels, uint32_t frame_count, const float* frequency_frames = nullptr, const float* amplitude_frames = nullptr)
+    {
+        switch( type )
+        {
+            case ma_waveform_type_sine:     render<ma_waveform_type_sine>    (frequency, amplitude, frequency_in, amplitude_in, in_channels, out, out_channels, frame_count, frequency_frames, amplitude_frames); break;
+            case ma_waveform_type_square:   render<ma_waveform_type_square>  (frequency, amplitude, frequency_in, amplitude_in, in_channels, out, out_channels, frame_count, frequency_frames, amplitude_frames); break;
+            case ma_waveform_type_triangle: render<ma_waveform_type_triangle>(frequency, amplitude, frequency_in, amplitude_in, in_channels, out, out_channels, frame_count, frequency_frames, amplitude_frames); break;
+            case ma_waveform_type_sawtooth: render<ma_waveform_type_sawtooth>(frequency, amplitude, frequency_in, amplitude_in, in_channels, out, out_channels, frame_count, frequency_frames, amplitude_frames); break;
+            default: std::fill(out, out + frame_count*out_channels, 0.0f); break;
+        }
+    }
+
+    // the waveform at phase (in [0, 1)), with an amplitude of 1
+    template<ma_waveform_type type>
+    static simd::f32x4 shape(simd::f32x4 phase)
+    {
+        using namespace simd;
+
+        if constexpr( type == ma_waveform_type_sine )
+        {
+            // sin(2*pi*phase) = -sin(2*pi*y), with y = phase - 0.5 in [-0.5, 0.5). then reflect y into [-0.25, 0.25]
+            // (sin(2*pi*y) = sin(2*pi*(+-0.5 - y))), where a degree 9 taylor polynomial is good to ~4e-6
+            f32x4 y = phase - set1(0.5f);
+            y = select(set1(0.25f) < abs(y), copysign(set1(0.5f), y) - y, y);
+
+            const f32x4 z = y*set1(6.283185307f);
+            const f32x4 z2 = z*z;
+            f32x4 polynomial = set1(1.0f / 362880.0f);
+            polynomial = mul_add(polynomial, z2, set1(-1.0f / 5040.0f));
+            polynomial = mul_add(polynomial, z2, set1(1.0f / 120.0f));
+            polynomial = mul_add(polynomial, z2, set1(-1.0f / 6.0f));
+            polynomial = mul_add(polynomial, z2, set1(1.0f));
+
+            return set1(0.0f) - z*polynomial;
+        }
+        else if constexpr( type == ma_waveform_type_square ) return select(phase < set1(0.5f), set1(1.0f), set1(-1.0f));
+        else if constexpr( type == ma_waveform_type_triangle ) return set1(2.0f)*abs(set1(2.0f)*(phase - set1(0.5f))) - set1(1.0f);
+        else return set1(2.0f)*(phase - set1(0.5f)); // (sawtooth)
+    }
+
+private:
+    template<ma_waveform_type type>
+    void render(float frequency, float amplitude, const float* frequency_in, const float* amplitude_in, uint32_t in_channels, float* out, uint32_t out_channels, uint32_t frame_count, const float* frequency_frames, const float* amplitude_frames)
+    {
+        using namespace simd;
+
+        const f32x4 seconds_per_frame = set1(1.0f / sample_rate);
+        const f32x4 base_frequency = set1(frequency);
+        const f32x4 base_amplitude = set1(amplitude);
+
+        const bool from_table = band_limited && type != ma_waveform_type_sine;
+        const wavetable_bank& bank = wavetable_bank::get();
+        // (with a constant frequency, every frame plays from the same table)
+        const float* fixed_table = bank.table(type, wavetable_bank::octave_for(frequency / sample_rate));
+
+        float samples[4];
+
+        for( uint32_t i = 0; i < frame_count; i += 4 )
+        {
+            const uint32_t n = std::min<uint32_t>(4, frame_count - i);
+
+            f32x4 frame_frequency = frequency_frames ? load_strided(frequency_frames + i, 1, n) : base_frequency;
+            if( frequency_in ) frame_frequency = frame_frequency + load_strided(frequency_in + i*in_channels, in_channels, n);
+
+            f32x4 frame_amplitude = amplitude_frames ? load_strided(amplitude_frames + i, 1, n) : base_amplitude;
+            if( amplitude_in ) frame_amplitude = frame_amplitude*(set1(1.0f) + load_strided(amplitude_in + i*in_channels, in_channels, n));
+
+            f32x4 increment = frame_frequency*seconds_per_frame;
+            if( n < 4 ) increment = increment*set(1.0f, n > 1 ? 1.0f : 0.0f, n > 2 ? 1.0f : 0.0f, 0.0f); // (the frames past the end mustn't advance the phase)
+
+            const f32x4 advanced = prefix_sum(increment);
+            f32x4 frame_phase = set1(static_cast<float>(phase)) + (advanced - increment);
+            frame_phase = frame_phase - floor(frame_phase);
+
+            if( from_table )
+            {
+                float phases[4], increments[4];
+                store(phases, frame_phase);
+                store(increments, increment);
+
+                // (one table for the whole step, going off of its highest frequency)
+                const float* table = fixed_table;
+                if( frequency_in || frequency_frames )
+                {
+                    const float highest = std::max( std::max(fabsf(increments[0]), fabsf(increments[1])), std::max(fabsf(increments[2]), fabsf(increments[3])) );
+                    table = bank.table(type, wavetable_bank::octave_for(highest));
+                }
+
+                for( uint32_t k = 0; k < 4; k++ ) samples[k] = wavetable_bank::lookup(table, phases[k]);
+                store(samples, load(samples)*frame_amplitude);
+            }
+            else store(samples, shape<type>(frame_phase)*frame_amplitude);
+
+            phase += first(broadcast_last(advanced));
+            phase -= std::floor(phase);
+
+            float* frame = out + i*out_channels;
+            if( out_channels == 2 )
+                for( uint32_t k = 0; k < n; k++ ) frame[2*k] = frame[2*k + 1] = samples[k];
+            else
+                for( uint32_t k = 0; k < n; k++ )
+                    for( uint32_t c = 0; c < out_channels; c++ ) frame[k*out_channels + c] = samples[k];
+        }
+    }
+}; // oscillator
+
+} // rhythm::dsp
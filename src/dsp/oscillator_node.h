@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+    OscillatorNode is the dsp graph's oscillator (see oscillator.h): frequency on input 0, amplitude on input 1
+*/
+
+#include <stdint.h>
+
+#include "miniaudio.h"
+
+#include "node.h"
+#include "oscillator.h"
+#include "parameter.h"
+
+namespace rhythm::dsp
+{
+
+struct OscillatorNode : public DSPNode
+{
+    enum Parameter : uint32_t { TYPE };
+    
+    // only touched by the audio thread once initialized
+    dsp::oscillator oscillator;
+    ma_waveform_type type { ma_waveform_type_sine }; // (see set_parameter)
+    
+    dsp::parameter frequency { 440.0f, dsp::parameter::exponential }; // INPUT 0
+    dsp::parameter amplitude { 0.5f }; // INPUT 1
+    float amplitude_frames[max_block_frames]; // (amplitude times gain, while either is ramping)
+    
+    ma_result init(ma_engine* p_engine) override
+    {
+        oscillator.sample_rate = static_cast<float>( ma_engine_get_sample_rate(p_engine) );
+        frequency.sample_rate = amplitude.sample_rate = oscillator.sample_rate;
+        dsp::wavetable_bank::get(); // (builds the band-limited tables now, rather than on the audio thread)
+        
+        return MA_SUCCESS;
+    }
+    
+    uint32_t get_input_count() const override { return 2; }
+    
+    void process(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count) override
+    {
+        process_with_gain(inputs, out, channels, frame_count, dsp::Gain{});
+    }
+    
+    // (the gain just scales the amplitude, so a multiplier after us costs nothing)
+    bool can_process_with_gain() const override { return true; }
+    void process_with_gain(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count, dsp::Gain gain) override
+    {
+        const float* frequency_frames = frequency.advance(frame_count);
+        const float* amplitude_ramp = amplitude.advance(frame_count);
+        
+        const float* scaled_amplitude_frames = nullptr;
+        if( amplitude_ramp || gain.frames )
+        {
+            for( uint32_t i = 0; i < frame_count; i++ ) amplitude_frames[i] = ( amplitude_ramp ? amplitude_ramp[i] : amplitude.value )*gain.at(i);
+            scaled_amplitude_frames = amplitude_frames;
+        }
+        
+        oscillator.process(
+            type,
+            frequency.value,
+            amplitude.value*gain.value,
+            inputs[0], inputs[1], channels,
+            out, channels, frame_count,
+            frequency_frames, scaled_amplitude_frames
+        );
+    }
+    
+    void set_parameter(uint32_t parameter, float value) override
+    {
+        if( parameter == TYPE ) type = (ma_waveform_type)static_cast<int>(value);
+    }
+    
+    void set_frequency(double p_frequency)
+    {
+        frequency.set( static_cast<float>(p_frequency) );
+    }
+    void set_amplitude(double p_amplitude)
+    {
+        amplitude.set( static_cast<float>(p_amplitude) );
+    }
+}; // OscillatorNode
+
+} // rhythm::dsp
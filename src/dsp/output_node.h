@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "miniaudio.h"
+
+#include "node.h"
+
+namespace rhythm::dsp
+{
+
+// the sink of the graph. it's never run as a step: the plan (see plan.h) copies whatever is connected to it
+// straight to the engine
+struct OutputNode : public DSPNode
+{
+    ma_result init(ma_engine* p_engine) override { return MA_SUCCESS; }
+
+    uint32_t get_input_count() const override { return 1; }
+    uint32_t get_output_count() const override { return 0; }
+
+    void process(const float* const* inputs, float* out, uint32_t channels, uint32_t frame_count) override
+    {
+        if( inputs[0] ) memcpy(out, inputs[0], sizeof(float)*frame_count*channels);
+        else memset(out, 0, sizeof(float)*frame_count*channels);
+    }
+}; // OutputNode
+
+} // rhythm::dsp
@@ -0,0 +1,95 @@
+#pragma once
+
+/*
+    parameter is a node setting (frequency, amplitude, ...) that the game thread sets and the audio thread glides to,
+    instead of jumping to it once per period (which zippers when dragging a slider)
+
+    the game thread only ever stores a target, and the audio thread loads it once per block in advance(). when the
+    target changed, a new ramp starts from wherever the value is right now, over ramp_seconds, either linear or
+    exponential (equal ratios per frame, which sounds even for frequencies. it falls back to linear when the value
+    would have to cross or touch 0). while ramping, advance() hands back a value per frame. once settled it returns
+    nullptr, so nodes can keep their constant-value fast path
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "node.h"
+
+namespace rhythm::dsp
+{
+
+struct parameter
+{
+    enum ramp_type : uint8_t { linear, exponential };
+
+    /* STATE */
+
+    // game thread -> audio thread
+    std::atomic<float> target;
+    std::atomic<float> ramp_seconds { 0.02f };
+
+    // owned by the audio thread
+    float value; // (the value at the start of the next block)
+    ramp_type ramp;
+    float sample_rate { 48000.0f };
+
+private:
+    float ramp_target;
+    float step { 0.0f }; // per frame. multiplied for an exponential ramp, added otherwise
+    bool multiply { false };
+    uint32_t remaining { 0 };
+    float frames[max_block_frames];
+
+public:
+    parameter(float p_value, ramp_type p_ramp = linear) : target(p_value), value(p_value), ramp(p_ramp), ramp_target(p_value) {}
+
+    /* OPERATIONS */
+
+    // GAME THREAD
+    void set(float p_target) { target.store(p_target, std::memory_order_relaxed); }
+    float get() const { return target.load(std::memory_order_relaxed); }
+
+    // AUDIO THREAD! moves frame_count (at most max_block_frames) frames along. returns each frame's value while
+    // ramping, or nullptr if it's just `value` the whole block
+    const float* advance(uint32_t frame_count)
+    {
+        const float new_target = target.load(std::memory_order_relaxed);
+        if( new_target != ramp_target ) start(new_target);
+        if( remaining == 0 ) return nullptr;
+
+        const uint32_t ramped = std::min(remaining, frame_count);
+        float v = value;
+        if( multiply ) for( uint32_t i = 0; i < ramped; i++ ) frames[i] = v *= step;
+        else for( uint32_t i = 0; i < ramped; i++ ) frames[i] = v += step;
+
+        remaining -= ramped;
+        if( remaining == 0 ) frames[ramped - 1] = v = ramp_target; // (no drift)
+        std::fill(frames + ramped, frames + frame_count, v);
+
+        value = v;
+        return frames;
+    }
+
+private:
+    void start(float new_target)
+    {
+        ramp_target = new_target;
+
+        const float seconds = ramp_seconds.load(std::memory_order_relaxed);
+        remaining = static_cast<uint32_t>( std::max(0.0f, seconds*sample_rate) );
+        if( remaining == 0 || !std::isfinite(value) || !std::isfinite(new_target) )
+        {
+            value = new_target;
+            remaining = 0;
+            return;
+        }
+
+        multiply = ( ramp == exponential && value*new_target > 0.0f );
+        step = multiply ? std::pow(new_target / value, 1.0f / remaining) : (new_target - value) / remaining;
+    }
+}; // parameter
+
+} // rhythm::dsp
@@ -0,0 +1,419 @@
+#pragma once
+
+/*
+    a Plan is the user's dsp graph, compiled into a flat list of Steps for the audio thread to run in order
+
+    instead of miniaudio pulling each node's inputs recursively every period (and keeping a buffer per node bus),
+    Plan::compile sorts the nodes feeding the output node topologically, once, on the game thread, whenever the
+    graph changes. the audio thread then just loops over steps. along the way, compile:
+        - gives every step's output a buffer in one flat arena, reusing buffers once nothing reads them anymore
+        - sums inputs with several connections with a mix step (what miniaudio does for an input bus)
+        - fuses a node that can scale its own output (eg. an oscillator) with a gain node (eg. a multiplier) that
+          is its only consumer, into one step, so that chain is a single pass with no buffer in between
+
+    plan_node is the miniaudio node that runs the current plan, attached straight to the engine's endpoint. the
+    game thread never touches anything the audio thread might be using: every change (a new plan, or a parameter
+    that can't just be an atomic) goes through a lock-free command queue, applied at the start of the next period
+
+    plans and nodes the audio thread might still be using are freed by epochs: every command gets a sequence
+    number, and at the end of each period the audio thread publishes the last one it applied. something unlinked
+    by command s (eg. a plan replaced by it, or a node no plan after it refers to) is freed on the game thread once
+    that reaches s, since by then the audio thread has finished a whole period without it
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "miniaudio.h"
+
+#include "node.h"
+#include "spsc_queue.h"
+
+namespace rhythm::dsp
+{
+
+// a connection from one node's output to another node's input, just like GraphEdit's
+struct Edge
+{
+    DSPNode* from { nullptr };
+    uint32_t from_port { 0 };
+    DSPNode* to { nullptr };
+    uint32_t to_port { 0 };
+
+    bool operator==(const Edge& other) const { return from == other.from && from_port == other.from_port && to == other.to && to_port == other.to_port; }
+}; // Edge
+
+struct Plan
+{
+    static constexpr uint32_t max_inputs { 4 };
+    static constexpr uint32_t max_frames { max_block_frames }; // per pass. longer blocks are run in several passes
+    static constexpr int32_t none { -1 };
+
+    struct Step
+    {
+        DSPNode* node { nullptr }; // (nullptr for a mix)
+        DSPNode* gain { nullptr }; // the gain node fused into this step, if there is one
+        std::array<int32_t, max_inputs> inputs; // buffer per input, or none
+        int32_t output { none };
+
+        // a mix sums the buffers mix_sources[mix_begin, mix_begin + mix_count) into output
+        uint32_t mix_begin { 0 };
+        uint32_t mix_count { 0 };
+
+        Step() { inputs.fill(none); }
+    }; // Step
+
+    /* STATE */
+
+    std::vector<Step> steps;
+    std::vector<int32_t> mix_sources;
+    std::vector<float> arena; // every buffer, max_frames*channels floats each
+    uint32_t buffer_count { 0 };
+    uint32_t channels { 2 };
+    int32_t output { none }; // the buffer the output node reads, or none for silence
+
+    uint32_t fused_count { 0 }; // (just for logging)
+
+    /* LEMMAS */
+
+    float* buffer(int32_t index) { return arena.data() + size_t(index)*max_frames*channels; }
+
+    /* OPERATIONS */
+
+    // AUDIO THREAD! runs every step, and writes what the output node reads into out
+    void run(float* out, uint32_t frame_count)
+    {
+        for( uint32_t offset = 0; offset < frame_count; offset += max_frames )
+        {
+            const uint32_t n = std::min(max_frames, frame_count - offset);
+
+            for( const Step& step : steps ) run_step(step, n);
+
+            if( output == none ) memset(out + size_t(offset)*channels, 0, size_t(n)*channels*sizeof(float));
+            else memcpy(out + size_t(offset)*channels, buffer(output), size_t(n)*channels*sizeof(float));
+        }
+    }
+
+    // AUDIO THREAD! runs one step for frame_count (at most max_frames) frames. (public so it can be timed, see bench/)
+    void run_step(const Step& step, uint32_t frame_count)
+    {
+        float* step_out = buffer(step.output);
+        const size_t samples = size_t(frame_count)*channels;
+
+        if( !step.node )
+        {
+            memcpy(step_out, buffer(mix_sources[step.mix_begin]), samples*sizeof(float));
+            for( uint32_t m = 1; m < step.mix_count; m++ )
+            {
+                const float* source = buffer(mix_sources[step.mix_begin + m]);
+                for( size_t i = 0; i < samples; i++ ) step_out[i] += source[i];
+            }
+            return;
+        }
+
+        const float* inputs[max_inputs];
+        for( uint32_t i = 0; i < max_inputs; i++ ) inputs[i] = ( step.inputs[i] == none ) ? nullptr : buffer(step.inputs[i]);
+
+        if( step.gain ) step.node->process_with_gain(inputs, step_out, channels, frame_count, step.gain->advance_gain(frame_count));
+        else step.node->process(inputs, step_out, channels, frame_count);
+    }
+
+    // sorts everything feeding output_node into steps. returns nullptr if the graph has a cycle anywhere, even among
+    // nodes that don't feed output_node (yet), so it's refused when it's made, not once something in it is connected
+    static std::unique_ptr<Plan> compile(const std::vector<Edge>& edges, const DSPNode* output_node, uint32_t channels)
+    {
+        std::unique_ptr<Plan> plan = std::make_unique<Plan>();
+        plan->channels = channels;
+
+        // incoming edges of each node, and how many edges leave each node
+        std::map<const DSPNode*, std::vector<const Edge*>> incoming;
+        std::map<const DSPNode*, uint32_t> outgoing_count;
+        for( const Edge& edge : edges )
+        {
+            if( edge.to_port >= std::min(edge.to->get_input_count(), max_inputs) ) continue;
+            incoming[edge.to].push_back(&edge);
+            outgoing_count[edge.from]++;
+        }
+        auto sources_of = [&](const DSPNode* node, uint32_t port)
+        {
+            std::vector<DSPNode*> sources;
+            for( const Edge* edge : incoming[node] ) if( edge->to_port == port ) sources.push_back(edge->from);
+            return sources;
+        };
+
+        // topological order (dependencies first) of every node feeding output_node, by depth first search
+        std::vector<DSPNode*> order;
+        std::map<const DSPNode*, int> state; // 0: unvisited, 1: visiting, 2: done
+        bool cyclic = false;
+        auto visit = [&](auto&& self, DSPNode* node) -> void
+        {
+            if( cyclic || state[node] == 2 ) return;
+            if( state[node] == 1 ) { cyclic = true; return; }
+
+            state[node] = 1;
+            for( const Edge* edge : incoming[node] ) self(self, edge->from);
+            state[node] = 2;
+            order.push_back(node);
+        };
+        // (every node with an edge out of it first, just to look for cycles)
+        for( const Edge& edge : edges ) visit(visit, edge.from);
+        if( cyclic ) return nullptr;
+        order.clear();
+        state.clear();
+
+        for( const Edge* edge : incoming[output_node] ) visit(visit, edge->from);
+        if( cyclic ) return nullptr;
+
+        // source -> gain node it's fused into
+        std::map<const DSPNode*, DSPNode*> fused_into;
+        std::map<const DSPNode*, DSPNode*> fused_from;
+        for( DSPNode* node : order )
+        {
+            if( !node->is_gain() ) continue;
+
+            const std::vector<DSPNode*> sources = sources_of(node, 0);
+            if( sources.size() != 1 || incoming[node].size() != 1 ) continue; // (something else is connected to it)
+
+            DSPNode* source = sources[0];
+            if( !source->can_process_with_gain() || outgoing_count[source] != 1 || source == output_node ) continue;
+
+            fused_into[source] = node;
+            fused_from[node] = source;
+        }
+
+        // steps, with logical buffers (one per value, renamed to real buffers below)
+        std::map<const DSPNode*, int32_t> value_of;
+        int32_t value_count = 0;
+        auto input_value = [&](const DSPNode* node, uint32_t port) -> int32_t
+        {
+            const std::vector<DSPNode*> sources = sources_of(node, port);
+            if( sources.empty() ) return none;
+            if( sources.size() == 1 ) return value_of[sources[0]];
+
+            Step mix;
+            mix.mix_begin = static_cast<uint32_t>( plan->mix_sources.size() );
+            mix.mix_count = static_cast<uint32_t>( sources.size() );
+            for( const DSPNode* source : sources ) plan->mix_sources.push_back(value_of[source]);
+            mix.output = value_count++;
+            plan->steps.push_back(mix);
+
+            return mix.output;
+        };
+
+        for( DSPNode* node : order )
+        {
+            if( fused_into.count(node) ) continue; // (runs as part of the gain node it's fused into)
+
+            Step step;
+            DSPNode* runs = node;
+            auto fused = fused_from.find(node);
+            if( fused != fused_from.end() )
+            {
+                runs = fused->second;
+                step.gain = node;
+                plan->fused_count++;
+            }
+
+            step.node = runs;
+            for( uint32_t port = 0; port < std::min(runs->get_input_count(), max_inputs); port++ ) step.inputs[port] = input_value(runs, port);
+            step.output = value_of[node] = value_count++;
+            plan->steps.push_back(step);
+        }
+        const int32_t output_value = input_value(output_node, 0);
+
+        // the last step each value is read by (the output is read after every step)
+        std::vector<size_t> last_read(value_count, 0);
+        for( size_t s = 0; s < plan->steps.size(); s++ )
+        {
+            const Step& step = plan->steps[s];
+            for( const int32_t value : step.inputs ) if( value != none ) last_read[value] = s;
+            for( uint32_t m = 0; m < step.mix_count; m++ ) last_read[plan->mix_sources[step.mix_begin + m]] = s;
+        }
+        if( output_value != none ) last_read[output_value] = plan->steps.size();
+
+        // give each value a real buffer, handing a buffer back once its value has been read for the last time.
+        // (a step's output never shares a buffer with its own inputs, so nodes never have to process in place)
+        std::vector<int32_t> buffer_of(value_count, none);
+        std::vector<int32_t> free_buffers;
+        auto rename = [&](int32_t& value) { if( value != none ) value = buffer_of[value]; };
+        for( size_t s = 0; s < plan->steps.size(); s++ )
+        {
+            Step& step = plan->steps[s];
+            std::vector<int32_t> read;
+            for( const int32_t value : step.inputs ) if( value != none ) read.push_back(value);
+            for( uint32_t m = 0; m < step.mix_count; m++ ) read.push_back(plan->mix_sources[step.mix_begin + m]);
+
+            if( free_buffers.empty() ) free_buffers.push_back(static_cast<int32_t>( plan->buffer_count++ ));
+            buffer_of[step.output] = free_buffers.back();
+            free_buffers.pop_back();
+
+            for( int32_t& value : step.inputs ) rename(value);
+            for( uint32_t m = 0; m < step.mix_count; m++ ) rename(plan->mix_sources[step.mix_begin + m]);
+
+            std::sort(read.begin(), read.end());
+            read.erase(std::unique(read.begin(), read.end()), read.end());
+            for( const int32_t value : read ) if( last_read[value] == s ) free_buffers.push_back(buffer_of[value]);
+
+            step.output = buffer_of[step.output];
+        }
+        plan->output = ( output_value == none ) ? none : buffer_of[output_value];
+
+        plan->arena.assign(size_t(plan->buffer_count)*max_frames*channels, 0.0f);
+
+        return plan;
+    }
+}; // Plan
+
+struct plan_node
+{
+    ma_node_base base;
+    bool initialized { false };
+
+    struct Command
+    {
+        enum Type : uint8_t { swap_plan, set_parameter };
+
+        Type type { swap_plan };
+        uint64_t sequence { 0 };
+        Plan* plan { nullptr }; // swap_plan
+        DSPNode* node { nullptr }; // set_parameter
+        uint32_t parameter { 0 };
+        float value { 0.0f };
+    }; // Command
+
+    // something to free once the audio thread has applied command `sequence`
+    struct Retired
+    {
+        uint64_t sequence { 0 };
+        Plan* plan { nullptr };
+        DSPNode* node { nullptr };
+    }; // Retired
+
+    /* STATE */
+
+    // game thread -> audio thread
+    spsc_queue<Command, 256> commands;
+    // audio thread -> game thread. the sequence of the last command applied, as of the end of the last period
+    std::atomic<uint64_t> applied { 0 };
+
+    // owned by the game thread
+    uint64_t sent { 0 }; // the sequence of the last command sent
+    std::vector<Command> backlog; // (commands that didn't fit in the queue yet, in order)
+    std::vector<Retired> retired;
+    Plan* published { nullptr }; // the last plan sent
+
+    // owned by the audio thread
+    Plan* active { nullptr };
+    uint64_t last_applied { 0 };
+
+    static void process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+
+    static inline ma_node_vtable vtable { process, nullptr, 0, 1, MA_NODE_FLAG_CONTINUOUS_PROCESSING };
+
+    /* OPERATIONS */
+
+    ma_result init(ma_engine* p_engine)
+    {
+        ma_uint32 output_channels[1] { ma_engine_get_channels(p_engine) };
+
+        ma_node_config node_config = ma_node_config_init();
+        node_config.vtable = &vtable;
+        node_config.pOutputChannels = output_channels;
+
+        ma_result result = ma_node_init(ma_engine_get_node_graph(p_engine), &node_config, nullptr, &base);
+        if( result != MA_SUCCESS ) return result;
+        initialized = true;
+
+        result = ma_node_attach_output_bus(&base, 0, ma_engine_get_endpoint(p_engine), 0);
+        if( result != MA_SUCCESS ) return result;
+
+        return ma_node_set_state(&base, ma_node_state_started);
+    }
+
+    // ma_node_uninit() detaches us from the graph (waiting on the audio thread if it has to) before anything is freed
+    void uninit()
+    {
+        if( initialized ) ma_node_uninit(&base, nullptr);
+        initialized = false;
+
+        for( const Retired& r : retired ) { delete r.plan; delete r.node; }
+        retired.clear();
+        backlog.clear();
+        delete published;
+        published = nullptr;
+        active = nullptr;
+    }
+
+    // GAME THREAD ONLY! sends whatever is backlogged, and frees whatever the audio thread is done with
+    void collect()
+    {
+        size_t sent_count = 0;
+        while( sent_count < backlog.size() && commands.push(backlog[sent_count]) ) sent_count++;
+        backlog.erase(backlog.begin(), backlog.begin() + sent_count);
+
+        const uint64_t done = applied.load(std::memory_order_acquire);
+        auto first_kept = std::partition(retired.begin(), retired.end(), [done](const Retired& r) { return r.sequence > done; });
+        for( auto r = first_kept; r != retired.end(); r++ ) { delete r->plan; delete r->node; }
+        retired.erase(first_kept, retired.end());
+    }
+
+    // GAME THREAD ONLY!
+    void send(Command command)
+    {
+        command.sequence = ++sent;
+        backlog.push_back(command);
+        collect();
+    }
+
+    // GAME THREAD ONLY! the audio thread switches to plan at the start of its next period
+    void publish(std::unique_ptr<Plan> plan)
+    {
+        if( published ) retired.push_back({ sent + 1, published, nullptr });
+        published = plan.release();
+
+        send({ Command::swap_plan, 0, published });
+    }
+
+    // GAME THREAD ONLY! calls node->set_parameter(parameter, value) on the audio thread
+    void set_parameter(DSPNode* node, uint32_t parameter, float value)
+    {
+        send({ Command::set_parameter, 0, nullptr, node, parameter, value });
+    }
+
+    // GAME THREAD ONLY! deletes node once the audio thread can't be using it, ie. once the last command sent (which
+    // should be the plan that no longer has it) has been applied
+    void retire(DSPNode* node)
+    {
+        retired.push_back({ sent, nullptr, node });
+    }
+}; // plan_node
+
+inline void plan_node::process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+{
+    plan_node* node = (plan_node*)pNode;
+
+    Command command;
+    while( node->commands.pop(command) )
+    {
+        switch( command.type )
+        {
+            case Command::swap_plan: node->active = command.plan; break;
+            case Command::set_parameter: command.node->set_parameter(command.parameter, command.value); break;
+        }
+        node->last_applied = command.sequence;
+    }
+
+    if( node->active ) node->active->run(ppFramesOut[0], *pFrameCountOut);
+    else memset(ppFramesOut[0], 0, sizeof(float)*(*pFrameCountOut)*ma_node_get_output_channels(pNode, 0));
+
+    // (nothing from before last_applied is used past this point)
+    node->applied.store(node->last_applied, std::memory_order_release);
+}
+
+} // rhythm::dsp
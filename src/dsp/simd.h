@@ -0,0 +1,262 @@
+#pragma once
+
+/*
+    f32x4 is 4 floats processed together: SSE2 on x86_64 (which every x86_64 cpu has), NEON on arm64, and plain
+    scalar code everywhere else. only what the dsp kernels need is here, so add to it as they need more
+
+    it's 4 wide and not 8 (AVX) on purpose: AVX isn't guaranteed on x86_64, and godot-cpp doesn't build with
+    -mavx, so an AVX path would never actually be compiled in without runtime dispatch
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RHYTHM_SIMD_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #define RHYTHM_SIMD_NEON
+    #include <arm_neon.h>
+#else
+    #define RHYTHM_SIMD_SCALAR
+#endif
+
+namespace rhythm::dsp::simd
+{
+
+#if defined(RHYTHM_SIMD_SSE2)
+    static constexpr const char* name { "sse2" };
+#elif defined(RHYTHM_SIMD_NEON)
+    static constexpr const char* name { "neon" };
+#else
+    static constexpr const char* name { "scalar" };
+#endif
+
+struct f32x4
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    __m128 v;
+#elif defined(RHYTHM_SIMD_NEON)
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+}; // f32x4
+
+/* LOAD / STORE */
+
+inline f32x4 load(const float* p)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_loadu_ps(p) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vld1q_f32(p) };
+#else
+    f32x4 r; memcpy(r.v, p, sizeof(r.v)); return r;
+#endif
+}
+
+inline void store(float* p, f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    _mm_storeu_ps(p, a.v);
+#elif defined(RHYTHM_SIMD_NEON)
+    vst1q_f32(p, a.v);
+#else
+    memcpy(p, a.v, sizeof(a.v));
+#endif
+}
+
+inline f32x4 set1(float x)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_set1_ps(x) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vdupq_n_f32(x) };
+#else
+    return { { x, x, x, x } };
+#endif
+}
+
+inline f32x4 set(float x0, float x1, float x2, float x3)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_setr_ps(x0, x1, x2, x3) };
+#elif defined(RHYTHM_SIMD_NEON)
+    const float x[4] { x0, x1, x2, x3 };
+    return { vld1q_f32(x) };
+#else
+    return { { x0, x1, x2, x3 } };
+#endif
+}
+
+// every stride'th float from p, ie. one channel of interleaved frames. lanes past n are 0
+inline f32x4 load_strided(const float* p, uint32_t stride, uint32_t n)
+{
+    if( n >= 4 ) return set(p[0], p[stride], p[2*stride], p[3*stride]);
+    return set(p[0], n > 1 ? p[stride] : 0.0f, n > 2 ? p[2*stride] : 0.0f, 0.0f);
+}
+
+inline float first(f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return _mm_cvtss_f32(a.v);
+#elif defined(RHYTHM_SIMD_NEON)
+    return vgetq_lane_f32(a.v, 0);
+#else
+    return a.v[0];
+#endif
+}
+
+/* ARITHMETIC */
+
+inline f32x4 operator+(f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_add_ps(a.v, b.v) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vaddq_f32(a.v, b.v) };
+#else
+    return { { a.v[0]+b.v[0], a.v[1]+b.v[1], a.v[2]+b.v[2], a.v[3]+b.v[3] } };
+#endif
+}
+
+inline f32x4 operator-(f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_sub_ps(a.v, b.v) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vsubq_f32(a.v, b.v) };
+#else
+    return { { a.v[0]-b.v[0], a.v[1]-b.v[1], a.v[2]-b.v[2], a.v[3]-b.v[3] } };
+#endif
+}
+
+inline f32x4 operator*(f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_mul_ps(a.v, b.v) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vmulq_f32(a.v, b.v) };
+#else
+    return { { a.v[0]*b.v[0], a.v[1]*b.v[1], a.v[2]*b.v[2], a.v[3]*b.v[3] } };
+#endif
+}
+
+// a*b + c
+inline f32x4 mul_add(f32x4 a, f32x4 b, f32x4 c)
+{
+#if defined(RHYTHM_SIMD_NEON)
+    return { vfmaq_f32(c.v, a.v, b.v) };
+#else
+    return a*b + c;
+#endif
+}
+
+inline f32x4 floor(f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    // (truncate, then take 1 off wherever that rounded up, ie. negative non-integers)
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return { _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a.v), _mm_set1_ps(1.0f))) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vrndmq_f32(a.v) };
+#else
+    return { { std::floor(a.v[0]), std::floor(a.v[1]), std::floor(a.v[2]), std::floor(a.v[3]) } };
+#endif
+}
+
+inline f32x4 abs(f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vabsq_f32(a.v) };
+#else
+    return { { std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3]) } };
+#endif
+}
+
+// the magnitude of a, with the sign of b
+inline f32x4 copysign(f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    return { _mm_or_ps(_mm_andnot_ps(sign, a.v), _mm_and_ps(sign, b.v)) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vbslq_f32(vdupq_n_u32(0x80000000u), b.v, a.v) };
+#else
+    return { { std::copysign(a.v[0], b.v[0]), std::copysign(a.v[1], b.v[1]), std::copysign(a.v[2], b.v[2]), std::copysign(a.v[3], b.v[3]) } };
+#endif
+}
+
+/* COMPARISON */
+
+// lanes where a < b
+struct mask4
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    __m128 m;
+#elif defined(RHYTHM_SIMD_NEON)
+    uint32x4_t m;
+#else
+    bool m[4];
+#endif
+}; // mask4
+
+inline mask4 operator<(f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_cmplt_ps(a.v, b.v) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vcltq_f32(a.v, b.v) };
+#else
+    return { { a.v[0] < b.v[0], a.v[1] < b.v[1], a.v[2] < b.v[2], a.v[3] < b.v[3] } };
+#endif
+}
+
+// a where mask is set, b where it isn't
+inline f32x4 select(mask4 mask, f32x4 a, f32x4 b)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_or_ps(_mm_and_ps(mask.m, a.v), _mm_andnot_ps(mask.m, b.v)) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vbslq_f32(mask.m, a.v, b.v) };
+#else
+    return { { mask.m[0] ? a.v[0] : b.v[0], mask.m[1] ? a.v[1] : b.v[1], mask.m[2] ? a.v[2] : b.v[2], mask.m[3] ? a.v[3] : b.v[3] } };
+#endif
+}
+
+/* HORIZONTAL */
+
+// { a0, a0+a1, a0+a1+a2, a0+a1+a2+a3 }
+inline f32x4 prefix_sum(f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    a.v = _mm_add_ps(a.v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a.v), 4)));
+    a.v = _mm_add_ps(a.v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a.v), 8)));
+    return a;
+#elif defined(RHYTHM_SIMD_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    a.v = vaddq_f32(a.v, vextq_f32(zero, a.v, 3));
+    a.v = vaddq_f32(a.v, vextq_f32(zero, a.v, 2));
+    return a;
+#else
+    return { { a.v[0], a.v[0]+a.v[1], a.v[0]+a.v[1]+a.v[2], a.v[0]+a.v[1]+a.v[2]+a.v[3] } };
+#endif
+}
+
+// { a3, a3, a3, a3 }
+inline f32x4 broadcast_last(f32x4 a)
+{
+#if defined(RHYTHM_SIMD_SSE2)
+    return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(3, 3, 3, 3)) };
+#elif defined(RHYTHM_SIMD_NEON)
+    return { vdupq_laneq_f32(a.v, 3) };
+#else
+    return { { a.v[3], a.v[3], a.v[3], a.v[3] } };
+#endif
+}
+
+} // rhythm::dsp::simd
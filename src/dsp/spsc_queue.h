@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+    spsc_queue is a fixed size, lock-free ring buffer for exactly one producer thread and one consumer thread.
+    neither side ever blocks or allocates: push() fails when the queue is full, and pop() when it's empty
+
+    head and tail only ever count up (wrapping at 2^32, which is fine since capacity is a power of 2), and each is
+    written by one side only, on its own cache line so the two threads don't fight over it
+*/
+
+#include <stdint.h>
+#include <array>
+#include <atomic>
+
+namespace rhythm::dsp
+{
+
+template<typename T, uint32_t capacity>
+struct spsc_queue
+{
+    static_assert( capacity > 0 && (capacity & (capacity - 1)) == 0, "spsc_queue capacity must be a power of 2" );
+
+    /* STATE */
+
+    std::array<T, capacity> items;
+    alignas(64) std::atomic<uint32_t> head { 0 }; // next item to pop. only written by the consumer
+    alignas(64) std::atomic<uint32_t> tail { 0 }; // next item to push. only written by the producer
+
+    /* OPERATIONS */
+
+    // PRODUCER ONLY!
+    bool push(const T& item)
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if( t - head.load(std::memory_order_acquire) == capacity ) return false;
+
+        items[t & (capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // CONSUMER ONLY!
+    bool pop(T& item)
+    {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if( h == tail.load(std::memory_order_acquire) ) return false;
+
+        item = items[h & (capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+}; // spsc_queue
+
+} // rhythm::dsp
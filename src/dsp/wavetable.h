@@ -0,0 +1,109 @@
+#pragma once
+
+/*
+    wavetable_bank is a band-limited version of every ma_waveform_type, one table per octave, built once (on first
+    use) and shared by every oscillator
+
+    a naive square/sawtooth/triangle has harmonics all the way up, so anything above nyquist folds back down as
+    aliasing (badly, for high notes). instead, each table here is summed from only the harmonics that fit: table k
+    has (size/2) >> k of them, and an oscillator plays from the first table whose highest harmonic still lands
+    under nyquist at the frequency it's playing (see octave_for)
+
+    the series are the Fourier series of ma_waveform's own shapes (same phase, same sign), so switching an
+    oscillator between naive and band-limited doesn't shift or flip it
+*/
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "miniaudio.h"
+
+namespace rhythm::dsp
+{
+
+struct wavetable_bank
+{
+    static constexpr uint32_t size { 2048 }; // samples per table (a power of 2)
+    static constexpr uint32_t octaves { 11 }; // table k has (size/2) >> k harmonics, so the last has just the fundamental
+    static constexpr uint32_t types { 4 }; // sine, square, triangle, sawtooth
+    static constexpr uint32_t stride { size + 1 }; // (each table repeats its first sample at the end, so interpolating never wraps)
+
+    /* STATE */
+
+    std::vector<float> tables; // [type][octave][stride]
+
+    /* LEMMAS */
+
+    static const wavetable_bank& get()
+    {
+        static const wavetable_bank bank; // (built on first use, thread safe)
+        return bank;
+    }
+
+    const float* table(ma_waveform_type type, uint32_t octave) const { return &tables[(uint32_t(type)*octaves + octave)*stride]; }
+
+    static uint32_t harmonics(uint32_t octave) { return (size / 2) >> octave; }
+
+    // the table to play from at increment (frequency / sample rate), ie. the first whose harmonics are all under nyquist
+    static uint32_t octave_for(float increment)
+    {
+        // harmonics(k)*increment < 0.5, ie. (size/2)*increment*2 < 2^k
+        const float x = fabsf(increment)*size;
+        if( !(x >= 1.0f) ) return 0; // (also NaN)
+
+        int exponent;
+        frexpf(x, &exponent); // x = m * 2^exponent with m in [0.5, 1), so 2^(exponent - 1) <= x < 2^exponent
+        return std::min<uint32_t>(static_cast<uint32_t>(exponent), octaves - 1);
+    }
+
+    // linearly interpolated, phase in [0, 1)
+    static float lookup(const float* table, float phase)
+    {
+        const float position = phase*size;
+        const uint32_t index = std::min<uint32_t>(static_cast<uint32_t>(position), size - 1);
+        const float fraction = position - index;
+
+        return table[index] + fraction*(table[index + 1] - table[index]);
+    }
+
+private:
+    wavetable_bank() : tables(types*octaves*stride, 0.0f)
+    {
+        // sin(2*pi*n*i/size) is sine[n*i % size], so summing harmonics never calls sin()
+        std::vector<double> sine(size);
+        for( uint32_t i = 0; i < size; i++ ) sine[i] = sin(2.0*M_PI*i / size);
+
+        std::vector<double> sum(size);
+        for( uint32_t type = 0; type < types; type++ )
+            for( uint32_t octave = 0; octave < octaves; octave++ )
+            {
+                std::fill(sum.begin(), sum.end(), 0.0);
+
+                for( uint32_t n = 1; n <= harmonics(octave); n++ )
+                {
+                    double amplitude = 0.0;
+                    uint32_t quarter_turn = 0; // (size/4 for cos instead of sin)
+
+                    switch( (ma_waveform_type)type )
+                    {
+                        case ma_waveform_type_sine: amplitude = ( n == 1 ) ? 1.0 : 0.0; break;
+                        case ma_waveform_type_square: amplitude = ( n % 2 ) ? 4.0 / (M_PI*n) : 0.0; break; // +1 then -1
+                        case ma_waveform_type_triangle: amplitude = ( n % 2 ) ? 8.0 / (M_PI*M_PI*n*n) : 0.0; quarter_turn = size / 4; break; // 1 at 0, -1 at 0.5
+                        case ma_waveform_type_sawtooth: amplitude = -2.0 / (M_PI*n); break; // -1 up to 1
+                        default: break;
+                    }
+                    if( amplitude == 0.0 ) continue;
+
+                    for( uint32_t i = 0; i < size; i++ ) sum[i] += amplitude*sine[(uint64_t(n)*i + quarter_turn) % size];
+                }
+
+                float* t = &tables[(type*octaves + octave)*stride];
+                for( uint32_t i = 0; i < size; i++ ) t[i] = static_cast<float>(sum[i]);
+                t[size] = t[0];
+            }
+    }
+}; // wavetable_bank
+
+} // rhythm::dsp
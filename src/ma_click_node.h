@@ -0,0 +1,195 @@
+#pragma once
+
+/*
+    click_node is a miniaudio node that mixes a click sample in at every beat of the Conductor, from inside the
+    audio callback. each period it works out which beats land inside the block it is rendering, and starts the
+    click on exactly that frame, so the click never depends on how often (or how late) _process runs
+
+    the game thread never touches the node's state directly. instead, every time the Conductor changes (play,
+    pause, seek, pitch, beats), AudioEngine2 publishes a new Schedule. the audio thread picks it up at the start
+    of its next period, and hands the one it replaces back through `retired`, to be freed on the game thread
+
+    NOTE: only one Schedule is ever in flight. publishing twice before the audio thread gets to the first simply
+    replaces (and frees) the first, since the audio thread never saw it
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "miniaudio.h"
+
+#include "Conductor.h"
+
+namespace rhythm
+{
+
+struct click_node
+{
+    // everything the audio thread needs to know about the Conductor, copied so that it can be read without locks
+    struct Schedule
+    {
+        int64_t global_start_frame { Conductor::initial };
+        double pitch { 1.0 };
+        std::vector<int64_t> beats;
+    }; // Schedule
+
+    ma_node_base base;
+    ma_engine* engine { nullptr };
+
+    /* STATE */
+
+    // game thread -> audio thread
+    std::atomic<Schedule*> pending { nullptr };
+    // audio thread -> game thread
+    std::atomic<Schedule*> retired { nullptr };
+    std::atomic<bool> enabled { false };
+
+    // owned by the audio thread
+    Schedule* active { nullptr };
+    int64_t click_position { -1 }; // frame of the click sample we're on, or -1 if there is no click sounding
+
+    // the click sample, decoded upfront to the engine's format (f32, engine channels, engine sample rate)
+    float* click_frames { nullptr };
+    ma_uint64 click_length { 0 };
+    ma_uint32 channels { 2 };
+
+    static void process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+
+    static inline ma_node_vtable vtable { process, nullptr, 0, 1, MA_NODE_FLAG_CONTINUOUS_PROCESSING };
+
+    /* OPERATIONS */
+
+    ma_result init(ma_engine* p_engine, ma_vfs* p_vfs, const char* click_path)
+    {
+        channels = ma_engine_get_channels(p_engine);
+
+        ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, channels, ma_engine_get_sample_rate(p_engine));
+        void* frames = nullptr;
+        ma_result result = ma_decode_from_vfs(p_vfs, click_path, &decoder_config, &click_length, &frames);
+        if( result != MA_SUCCESS ) return result;
+        click_frames = static_cast<float*>(frames);
+
+        ma_uint32 output_channels[1] { channels };
+
+        ma_node_config node_config = ma_node_config_init();
+        node_config.vtable = &vtable;
+        node_config.pOutputChannels = output_channels;
+
+        result = ma_node_init(ma_engine_get_node_graph(p_engine), &node_config, nullptr, &base);
+        if( result != MA_SUCCESS ) return result;
+        engine = p_engine; // (only once base is initialized, since uninit() goes off of this)
+
+        result = ma_node_attach_output_bus(&base, 0, ma_engine_get_endpoint(engine), 0);
+        if( result != MA_SUCCESS ) return result;
+
+        return ma_node_set_state(&base, ma_node_state_started);
+    }
+
+    // ma_node_uninit() detaches us from the graph (waiting on the audio thread if it has to) before anything is freed
+    void uninit()
+    {
+        if( engine ) ma_node_uninit(&base, nullptr);
+        engine = nullptr;
+
+        delete pending.exchange(nullptr);
+        delete retired.exchange(nullptr);
+        delete active;
+        active = nullptr;
+
+        ma_free(click_frames, nullptr);
+        click_frames = nullptr;
+        click_length = 0;
+    }
+
+    // GAME THREAD ONLY! frees whatever the audio thread has finished with
+    void collect() { delete retired.exchange(nullptr, std::memory_order_acquire); }
+
+    // GAME THREAD ONLY! hands a copy of conductor's current timing to the audio thread
+    void publish(const Conductor& conductor)
+    {
+        collect();
+
+        Schedule* schedule = new Schedule;
+        schedule->global_start_frame = conductor.global_start_frame;
+        schedule->pitch = conductor.pitch;
+        schedule->beats.assign(conductor.beats.ptr(), conductor.beats.ptr() + conductor.beats.size());
+
+        delete pending.exchange(schedule, std::memory_order_acq_rel); // (if the audio thread never took the last one)
+    }
+}; // click_node
+
+inline void click_node::process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+{
+    click_node* node = (click_node*)pNode;
+
+    float* out = ppFramesOut[0];
+    const ma_uint32 frame_count = *pFrameCountOut;
+    const ma_uint32 channels = node->channels;
+
+    std::fill(out, out + frame_count*channels, 0.0f);
+
+    // adopt a new schedule, but only once the game thread has collected the last one we retired
+    if( node->retired.load(std::memory_order_acquire) == nullptr )
+    {
+        Schedule* schedule = node->pending.exchange(nullptr, std::memory_order_acq_rel);
+        if( schedule )
+        {
+            node->retired.store(node->active, std::memory_order_release);
+            node->active = schedule;
+        }
+    }
+
+    const Schedule* schedule = node->active;
+    const bool enabled = node->enabled.load(std::memory_order_relaxed);
+    // the engine's clock only advances once the whole graph has been read, so this is the first frame of this block
+    const int64_t block_start = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(node->engine) );
+    const int64_t block_end = block_start + frame_count;
+
+    // the next frame of this block to mix the click into
+    ma_uint32 i = 0;
+    auto mix_until = [&](ma_uint32 until)
+    {
+        for( ; i < until; i++ )
+        {
+            if( node->click_position < 0 ) continue;
+            if( static_cast<ma_uint64>(node->click_position) >= node->click_length )
+            {
+                node->click_position = -1;
+                continue;
+            }
+
+            const float* click_frame = &node->click_frames[node->click_position*channels];
+            for( ma_uint32 c = 0; c < channels; c++ ) out[i*channels + c] += click_frame[c];
+            node->click_position++;
+        }
+    };
+
+    if( enabled && schedule && schedule->global_start_frame != Conductor::initial && !schedule->beats.empty() && node->click_length > 0 )
+    {
+        const int64_t global_start_frame = schedule->global_start_frame;
+        const double pitch = schedule->pitch;
+        const std::vector<int64_t>& beats = schedule->beats;
+
+        // the first beat at or after the start of this block (in local time), same conversion as Conductor
+        const int64_t local_block_start = static_cast<int64_t>( (block_start - global_start_frame)*pitch );
+        auto it = std::lower_bound(beats.begin(), beats.end(), local_block_start);
+        if( it != beats.begin() ) it--; // (rounding can put the beat just before us on our first frame)
+
+        for( ; it != beats.end(); it++ )
+        {
+            const int64_t global_beat_frame = global_start_frame + static_cast<int64_t>( *it / pitch );
+            if( global_beat_frame < block_start ) continue;
+            if( global_beat_frame >= block_end ) break;
+
+            const ma_uint32 offset = static_cast<ma_uint32>( global_beat_frame - block_start );
+            mix_until(offset);
+            node->click_position = 0; // restart the click right on the beat
+        }
+    }
+
+    mix_until(frame_count);
+}
+
+} // rhythm
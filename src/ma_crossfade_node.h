@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+    crossfade_node is a miniaudio node with two input buses, that fades from one to the other starting on exactly
+    the engine frame it was told to, from inside the audio callback (see AudioEngine2::crossfade_to)
+
+    the fade is equal power: the incoming bus is scaled by sin(t*pi/2) and the outgoing one by cos(t*pi/2), so two
+    unrelated tracks keep the same loudness through the middle of it, instead of dipping like a linear fade does.
+    the gains cross (both at -3dB) halfway through, which is where AudioEngine2 hands the Conductor over
+
+    which bus is incoming alternates with every fade. once a fade is over its incoming bus stays at full volume (and
+    the outgoing one silent), so the sound it brought in can stay attached where it is, and be the outgoing side of
+    the next fade without being moved while it plays. before the first fade, it's as if a fade to bus 0 just ended
+
+    fades are handed to the audio thread like click_node's Schedules: through `pending`, with the one it replaces
+    handed back through `retired`, to be freed on the game thread
+*/
+
+#include <stdint.h>
+#include <math.h>
+#include <atomic>
+#include <algorithm>
+
+#include "miniaudio.h"
+
+namespace rhythm
+{
+
+struct crossfade_node
+{
+    struct Fade
+    {
+        int64_t start_frame { 0 }; // (engine frames)
+        int64_t length_in_frames { 0 };
+        ma_uint32 incoming_bus { 0 };
+    }; // Fade
+
+    ma_node_base base;
+    ma_engine* engine { nullptr };
+
+    /* STATE */
+
+    // game thread -> audio thread
+    std::atomic<Fade*> pending { nullptr };
+    // audio thread -> game thread
+    std::atomic<Fade*> retired { nullptr };
+
+    // owned by the audio thread
+    Fade* active { nullptr };
+
+    ma_uint32 channels { 2 };
+
+    static void process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut);
+
+    static inline ma_node_vtable vtable { process, nullptr, 2, 1, MA_NODE_FLAG_CONTINUOUS_PROCESSING };
+
+    /* OPERATIONS */
+
+    ma_result init(ma_engine* p_engine)
+    {
+        channels = ma_engine_get_channels(p_engine);
+
+        ma_uint32 input_channels[2] { channels, channels };
+        ma_uint32 output_channels[1] { channels };
+
+        ma_node_config node_config = ma_node_config_init();
+        node_config.vtable = &vtable;
+        node_config.pInputChannels = input_channels;
+        node_config.pOutputChannels = output_channels;
+
+        ma_result result = ma_node_init(ma_engine_get_node_graph(p_engine), &node_config, nullptr, &base);
+        if( result != MA_SUCCESS ) return result;
+        engine = p_engine; // (only once base is initialized, since uninit() goes off of this)
+
+        // our time is the engine's from here on, since we're processed (continuously) every period. see process()
+        ma_node_set_time(&base, ma_engine_get_time_in_pcm_frames(engine));
+
+        return ma_node_attach_output_bus(&base, 0, ma_engine_get_endpoint(engine), 0);
+    }
+
+    // ma_node_uninit() detaches us (and whatever is attached to us) from the graph before anything is freed
+    void uninit()
+    {
+        if( engine ) ma_node_uninit(&base, nullptr);
+        engine = nullptr;
+
+        delete pending.exchange(nullptr);
+        delete retired.exchange(nullptr);
+        delete active;
+        active = nullptr;
+    }
+
+    // GAME THREAD ONLY! frees whatever the audio thread has finished with
+    void collect() { delete retired.exchange(nullptr, std::memory_order_acquire); }
+
+    // GAME THREAD ONLY! fades over to incoming_bus, starting on engine frame start_frame
+    void publish(int64_t start_frame, int64_t length_in_frames, ma_uint32 incoming_bus)
+    {
+        collect();
+
+        Fade* fade = new Fade;
+        fade->start_frame = start_frame;
+        fade->length_in_frames = std::max<int64_t>(length_in_frames, 0);
+        fade->incoming_bus = incoming_bus & 1;
+
+        delete pending.exchange(fade, std::memory_order_acq_rel); // (if the audio thread never took the last one)
+    }
+}; // crossfade_node
+
+inline void crossfade_node::process(ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn, float** ppFramesOut, ma_uint32* pFrameCountOut)
+{
+    crossfade_node* node = (crossfade_node*)pNode;
+
+    float* out = ppFramesOut[0];
+    const ma_uint32 frame_count = *pFrameCountOut;
+    const ma_uint32 channels = node->channels;
+
+    // adopt a new fade, but only once the game thread has collected the last one we retired
+    if( node->retired.load(std::memory_order_acquire) == nullptr )
+    {
+        Fade* fade = node->pending.exchange(nullptr, std::memory_order_acq_rel);
+        if( fade )
+        {
+            node->retired.store(node->active, std::memory_order_release);
+            node->active = fade;
+        }
+    }
+
+    const Fade* fade = node->active;
+    const ma_uint32 incoming_bus = fade ? fade->incoming_bus : 0;
+    const float* incoming = ppFramesIn[incoming_bus];
+    const float* outgoing = ppFramesIn[1 - incoming_bus];
+
+    // the first frame of this block. not the engine's time, which is where the whole read started: the graph can
+    // process us in more than one go per read
+    const int64_t block_start = static_cast<int64_t>( ma_node_get_time(&node->base) );
+    const int64_t fade_start = fade ? fade->start_frame : 0;
+    const int64_t fade_end = fade ? fade->start_frame + fade->length_in_frames : 0;
+    constexpr double half_pi { 1.57079632679489661923 };
+
+    for( ma_uint32 i = 0; i < frame_count; i++ )
+    {
+        const int64_t frame = block_start + i;
+
+        // (exactly 0 and 1 either side of the fade, rather than whatever sin and cos round to)
+        float incoming_gain = 1.0f, outgoing_gain = 0.0f;
+        if( frame < fade_start )
+        {
+            incoming_gain = 0.0f;
+            outgoing_gain = 1.0f;
+        }
+        else if( frame < fade_end )
+        {
+            const double angle = double(frame - fade_start) / double(fade->length_in_frames) * half_pi;
+            incoming_gain = static_cast<float>( sin(angle) );
+            outgoing_gain = static_cast<float>( cos(angle) );
+        }
+
+        for( ma_uint32 c = 0; c < channels; c++ )
+            out[i*channels + c] = incoming[i*channels + c]*incoming_gain + outgoing[i*channels + c]*outgoing_gain;
+    }
+}
+
+} // rhythm
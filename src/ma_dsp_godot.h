@@ -4,29 +4,27 @@
 
 #include "miniaudio.h"
 
+#include "dsp/node.h"
+#include "dsp/plan.h"
+
 namespace rhythm::dsp
 {
 
 static godot::Color in_color  { 1, 1, 1, 1 };
 static godot::Color out_color { 1, 1, 0, 1 };
 
-struct DSPNode
-{
-    virtual ~DSPNode() = default;
-    virtual ma_result init(ma_engine* p_engine) = 0;
-    virtual ma_node* get_ma_node() = 0;
-}; // DSPNode
-
 struct DSPGraphNode : godot::GraphNode
 {
     GDCLASS(DSPGraphNode, godot::GraphNode)
 
 protected:
     DSPNode* dsp_node = nullptr;
+    plan_node* commands = nullptr; // (for parameters that have to be changed on the audio thread)
 
 public:
     virtual DSPNode* get_dsp_node() const { return dsp_node; }
     virtual void set_dsp_node(DSPNode* p_node ) { dsp_node = p_node; }
+    void set_commands(plan_node* p_commands) { commands = p_commands; }
     
     // turns the graph node red if there is no dsp node set
     void _draw() override
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+
 #include "miniaudio.h"
 
 #include <godot_cpp/classes/file_access.hpp>
@@ -22,20 +28,129 @@
    as well as open_and_read_file, since miniaudio will use the other functions as fallbacks
    
    ngl this code was written by gemini (3.1 Pro)
+   
+   every call into FileAccess crosses the GDExtension boundary, and decoders do a LOT of tiny reads and seeks
+   (a few bytes of a frame header at a time), so reads go through a small per-file cache of block_size blocks
+   instead. a miss reads the whole block in one get_buffer(), seek/tell/info never touch FileAccess at all, and
+   a read bigger than a block skips the cache and goes straight to get_buffer(). the counters on each file
+   (added to ma_vfs_godot_struct once it's closed) show how much that's saving
 */
 
-inline godot::Ref<godot::FileAccess>* get_file_ptr(ma_vfs_file file) { return static_cast<godot::Ref<godot::FileAccess>*>(file); }
+struct ma_vfs_godot_file
+{
+   struct Block
+   {
+      std::vector<uint8_t> data;
+      uint64_t index { UINT64_MAX }; // which block of the file this is, UINT64_MAX if it holds nothing yet
+      uint64_t last_used { 0 };
+   }; // Block
+   
+   godot::Ref<godot::FileAccess> file;
+   uint64_t length { 0 };
+   uint64_t cursor { 0 }; // where miniaudio thinks it is
+   uint64_t file_position { 0 }; // where FileAccess actually is, so we only seek() it when we have to
+   
+   size_t block_size { 0 };
+   std::vector<Block> blocks;
+   uint64_t tick { 0 };
+   
+   // counters
+   uint64_t read_calls { 0 }; // from miniaudio
+   uint64_t bytes_read { 0 };
+   uint64_t block_hits { 0 };
+   uint64_t block_misses { 0 };
+   uint64_t backend_calls { 0 }; // into FileAccess, ie. boundary crossings
+}; // ma_vfs_godot_file
+
+struct ma_vfs_godot_struct
+{
+   ma_vfs_callbacks cb;
+   
+   // only applies to files opened after it's changed
+   std::atomic<size_t> block_size { 32 << 10 };
+   std::atomic<size_t> block_count { 4 };
+   
+   // totals of every closed file's counters (files are opened and closed from the resource manager's threads too)
+   std::atomic<uint64_t> files_opened { 0 };
+   std::atomic<uint64_t> read_calls { 0 };
+   std::atomic<uint64_t> bytes_read { 0 };
+   std::atomic<uint64_t> block_hits { 0 };
+   std::atomic<uint64_t> block_misses { 0 };
+   std::atomic<uint64_t> backend_calls { 0 };
+   
+   ma_vfs_godot_struct();
+}; // ma_vfs_godot_struct
+
+inline ma_vfs_godot_file* get_file_ptr(ma_vfs_file file) { return static_cast<ma_vfs_godot_file*>(file); }
+
+// reads straight from FileAccess at position, seeking it first if it isn't already there
+inline uint64_t ma_vfs_godot_read_backend(ma_vfs_godot_file* file_ptr, uint64_t position, uint8_t* pDst, uint64_t size)
+{
+   if( file_ptr->file_position != position )
+   {
+      file_ptr->file->seek(position);
+      file_ptr->backend_calls++;
+   }
+   
+   uint64_t bytes_read = file_ptr->file->get_buffer(pDst, size);
+   file_ptr->backend_calls++;
+   file_ptr->file_position = position + bytes_read;
+   
+   return bytes_read;
+}
+
+// the cached block with the given index, reading it in (over the least recently used block) if it isn't cached
+inline ma_vfs_godot_file::Block* ma_vfs_godot_get_block(ma_vfs_godot_file* file_ptr, uint64_t index)
+{
+   ma_vfs_godot_file::Block* lru = &file_ptr->blocks[0];
+   for( ma_vfs_godot_file::Block& block : file_ptr->blocks )
+   {
+      if( block.index == index )
+      {
+         file_ptr->block_hits++;
+         block.last_used = ++file_ptr->tick;
+         return &block;
+      }
+      if( block.last_used < lru->last_used ) lru = &block;
+   }
+   
+   file_ptr->block_misses++;
+   
+   const uint64_t start = index*file_ptr->block_size;
+   const uint64_t size = std::min<uint64_t>(file_ptr->block_size, file_ptr->length - start);
+   
+   lru->data.resize(file_ptr->block_size);
+   if( ma_vfs_godot_read_backend(file_ptr, start, lru->data.data(), size) != size )
+   {
+      lru->index = UINT64_MAX; // (don't keep a short block around as if it were the real thing)
+      lru->last_used = 0;
+      return nullptr;
+   }
+   
+   lru->index = index;
+   lru->last_used = ++file_ptr->tick;
+   
+   return lru;
+}
 
 ma_result ma_vfs_open_godot(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile)
 {
    if( openMode & MA_OPEN_MODE_WRITE ) return MA_NOT_IMPLEMENTED; 
+   ma_vfs_godot_struct* vfs = (ma_vfs_godot_struct*)pVFS;
    
    godot::String path = godot::String::utf8(pFilePath);
    godot::Ref<godot::FileAccess> file = godot::FileAccess::open(path, godot::FileAccess::READ);
    
    if( file.is_null() ) return MA_DOES_NOT_EXIST;
    
-   godot::Ref<godot::FileAccess>* file_ptr = new godot::Ref<godot::FileAccess>(file); // malloc
+   ma_vfs_godot_file* file_ptr = new ma_vfs_godot_file; // malloc
+   file_ptr->file = file;
+   file_ptr->length = file->get_length();
+   file_ptr->block_size = std::max<size_t>(1, vfs->block_size.load(std::memory_order_relaxed));
+   file_ptr->blocks.resize(std::max<size_t>(1, vfs->block_count.load(std::memory_order_relaxed))); // (data is only allocated once a block is used)
+   file_ptr->backend_calls = 2; // open + get_length
+   
+   vfs->files_opened.fetch_add(1, std::memory_order_relaxed);
    
    *pFile = (ma_vfs_file)file_ptr;
    
@@ -45,9 +160,17 @@ ma_result ma_vfs_open_godot(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openM
 ma_result ma_vfs_close_godot(ma_vfs* pVFS, ma_vfs_file file)
 {
    if( file == nullptr ) return MA_INVALID_FILE;
-   godot::Ref<godot::FileAccess>* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_file* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_struct* vfs = (ma_vfs_godot_struct*)pVFS;
+   
+   if( file_ptr->file.is_valid() ) file_ptr->file->close();
+   
+   vfs->read_calls.fetch_add(file_ptr->read_calls, std::memory_order_relaxed);
+   vfs->bytes_read.fetch_add(file_ptr->bytes_read, std::memory_order_relaxed);
+   vfs->block_hits.fetch_add(file_ptr->block_hits, std::memory_order_relaxed);
+   vfs->block_misses.fetch_add(file_ptr->block_misses, std::memory_order_relaxed);
+   vfs->backend_calls.fetch_add(file_ptr->backend_calls + 1, std::memory_order_relaxed); // (+1 for close)
    
-   if( file_ptr->is_valid() ) (*file_ptr)->close();
    delete file_ptr; // free
 
    return MA_SUCCESS;
@@ -56,9 +179,43 @@ ma_result ma_vfs_close_godot(ma_vfs* pVFS, ma_vfs_file file)
 ma_result ma_vfs_read_godot(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead)
 {
    if( file == nullptr ) return MA_INVALID_FILE;
-   godot::Ref<godot::FileAccess>* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_file* file_ptr = get_file_ptr(file);
    
-   uint64_t bytes_read = (*file_ptr)->get_buffer(static_cast<uint8_t*>(pDst), sizeInBytes);
+   file_ptr->read_calls++;
+   
+   uint8_t* dst = static_cast<uint8_t*>(pDst);
+   const uint64_t end = std::min<uint64_t>(file_ptr->length, file_ptr->cursor + sizeInBytes);
+   uint64_t bytes_read = 0;
+   
+   while( file_ptr->cursor < end )
+   {
+      const uint64_t index = file_ptr->cursor / file_ptr->block_size;
+      const uint64_t offset = file_ptr->cursor % file_ptr->block_size;
+      const uint64_t remaining = end - file_ptr->cursor;
+      
+      // at least a whole block left to read, so caching it would only cost us a copy
+      if( offset == 0 && remaining >= file_ptr->block_size )
+      {
+         const uint64_t direct_size = remaining - remaining % file_ptr->block_size;
+         const uint64_t direct_read = ma_vfs_godot_read_backend(file_ptr, file_ptr->cursor, dst + bytes_read, direct_size);
+         
+         bytes_read += direct_read;
+         file_ptr->cursor += direct_read;
+         if( direct_read != direct_size ) break;
+         continue;
+      }
+      
+      const ma_vfs_godot_file::Block* block = ma_vfs_godot_get_block(file_ptr, index);
+      if( block == nullptr ) break;
+      
+      const uint64_t size = std::min<uint64_t>(remaining, file_ptr->block_size - offset);
+      memcpy(dst + bytes_read, block->data.data() + offset, size);
+      
+      bytes_read += size;
+      file_ptr->cursor += size;
+   }
+   
+   file_ptr->bytes_read += bytes_read;
    
    if( pBytesRead != nullptr ) *pBytesRead = bytes_read;
    if( bytes_read == 0 && sizeInBytes > 0 ) return MA_AT_END;
@@ -66,18 +223,21 @@ ma_result ma_vfs_read_godot(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t s
    return MA_SUCCESS;
 }
 
+// seeking only moves our own cursor. FileAccess catches up on the next block we actually have to read
 ma_result ma_vfs_seek_godot(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin)
 {
    if( file == nullptr ) return MA_INVALID_FILE;
-   godot::Ref<godot::FileAccess>* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_file* file_ptr = get_file_ptr(file);
    
-   uint64_t target_pos = 0;
+   ma_int64 target_pos = 0;
 
    if     ( origin == ma_seek_origin_start   ) target_pos = offset;
-   else if( origin == ma_seek_origin_current ) target_pos = (*file_ptr)->get_position() + offset;
-   else if( origin == ma_seek_origin_end     ) target_pos = (*file_ptr)->get_length() + offset;
+   else if( origin == ma_seek_origin_current ) target_pos = (ma_int64)file_ptr->cursor + offset;
+   else if( origin == ma_seek_origin_end     ) target_pos = (ma_int64)file_ptr->length + offset;
+   
+   if( target_pos < 0 ) return MA_BAD_SEEK;
 
-   (*file_ptr)->seek(target_pos);
+   file_ptr->cursor = (uint64_t)target_pos;
    
    return MA_SUCCESS;
 }
@@ -85,9 +245,9 @@ ma_result ma_vfs_seek_godot(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_
 ma_result ma_vfs_tell_godot(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor)
 {
    if( file == nullptr ) return MA_INVALID_FILE;
-   godot::Ref<godot::FileAccess>* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_file* file_ptr = get_file_ptr(file);
    
-   if( pCursor != nullptr ) *pCursor = (*file_ptr)->get_position();
+   if( pCursor != nullptr ) *pCursor = (ma_int64)file_ptr->cursor;
    
    return MA_SUCCESS;
 }
@@ -95,9 +255,9 @@ ma_result ma_vfs_tell_godot(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor)
 ma_result ma_vfs_info_godot(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo)
 {
    if( file == nullptr ) return MA_INVALID_FILE;
-   godot::Ref<godot::FileAccess>* file_ptr = get_file_ptr(file);
+   ma_vfs_godot_file* file_ptr = get_file_ptr(file);
    
-   if( pInfo != nullptr ) pInfo->sizeInBytes = (*file_ptr)->get_length();
+   if( pInfo != nullptr ) pInfo->sizeInBytes = file_ptr->length;
    
    return MA_SUCCESS;
 }
@@ -114,4 +274,4 @@ static ma_vfs_callbacks ma_vfs_callbacks_godot
     ma_vfs_info_godot
 };
 
-struct ma_vfs_godot_struct { ma_vfs_callbacks cb = ma_vfs_callbacks_godot; };
\ No newline at end of file
+inline ma_vfs_godot_struct::ma_vfs_godot_struct() : cb(ma_vfs_callbacks_godot) {}
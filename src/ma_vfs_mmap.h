@@ -0,0 +1,253 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "miniaudio.h"
+#include "ma_vfs_godot.h"
+#include "MappedFile.h"
+#include "AudioArchive.h"
+
+#include <godot_cpp/classes/project_settings.hpp>
+
+/*
+   ma_vfs_mmap is an ma_vfs that memory-maps audio files living on the real filesystem (absolute paths, like the
+   ones the Fingerprinter finds, and user:// paths), and hands everything else (res://, which may be inside the
+   .pck) to ma_vfs_godot. which backend a file gets is decided per path in ma_vfs_mmap_resolve()
+
+   before any of that though, if an AudioArchive is mounted and has the path, the file is a slice of the archive
+   instead: a view into it if it's mapped, or read out of it (through a small read-ahead buffer) if it isn't
+
+   a mapped file never calls into FileAccess (or the OS) after opening: seek/tell/info are just our cursor, and
+   a read is one memcpy straight out of the OS's file cache. miniaudio always reads into its own buffer, so
+   that memcpy is as close to zero-copy as the ma_vfs callbacks go. a decoder that doesn't need the vfs at all
+   can skip it by asking ma_vfs_mmap_view() for the bytes and decoding them in place (see AsyncDecode)
+*/
+
+struct ma_vfs_mmap_file
+{
+   static constexpr uint64_t read_ahead_size { 32 << 10 };
+
+   std::unique_ptr<rhythm::MappedFile> mapping; // (if the file is mapped on its own)
+   const rhythm::AudioArchive::Entry* entry { nullptr }; // (if the file is in the archive)
+
+   // the file's bytes, if they're mapped (either from mapping or the archive's mapping)
+   const uint8_t* data { nullptr };
+   uint64_t length { 0 };
+   uint64_t cursor { 0 };
+
+   // for an archive entry that isn't mapped
+   std::vector<uint8_t> read_ahead;
+   uint64_t read_ahead_start { 0 };
+
+   ma_vfs_file fallback_file { nullptr };
+}; // ma_vfs_mmap_file
+
+struct ma_vfs_mmap_struct
+{
+   ma_vfs_callbacks cb;
+   ma_vfs* fallback { nullptr }; // for anything we don't map
+   const rhythm::AudioArchive* archive { nullptr }; // (only ever set while no files are open)
+
+   std::atomic<uint64_t> files_mapped { 0 };
+   std::atomic<uint64_t> files_archived { 0 };
+   std::atomic<uint64_t> files_fallback { 0 };
+
+   ma_vfs_mmap_struct();
+}; // ma_vfs_mmap_struct
+
+inline ma_vfs_mmap_file* get_mmap_file_ptr(ma_vfs_file file) { return static_cast<ma_vfs_mmap_file*>(file); }
+
+// the filesystem path to map for pFilePath, or an empty path if it should go to the fallback instead
+inline std::filesystem::path ma_vfs_mmap_resolve(const char* pFilePath)
+{
+   const std::string path { pFilePath };
+
+   if( path.rfind("user://", 0) == 0 ) return std::filesystem::u8path( godot::ProjectSettings::get_singleton()->globalize_path(godot::String::utf8(pFilePath)).utf8().get_data() );
+   if( path.find("://") != std::string::npos ) return {}; // (res://, uid://, ...)
+
+   std::filesystem::path fs_path = std::filesystem::u8path(path);
+   return fs_path.is_absolute() ? fs_path : std::filesystem::path {};
+}
+
+// pFilePath's bytes, if they're already in memory (an entry of a mapped archive) or can be mapped (a file on the
+// real filesystem, kept alive by mapping), so a decoder can read them in place with ma_decoder_init_memory. null if
+// the file can only be read through the vfs (res://, an archive that isn't mapped, ...)
+inline const uint8_t* ma_vfs_mmap_view(ma_vfs_mmap_struct* vfs, const char* pFilePath, uint64_t& length, std::unique_ptr<rhythm::MappedFile>& mapping)
+{
+   if( vfs->archive )
+   {
+      if( const rhythm::AudioArchive::Entry* entry = vfs->archive->find(pFilePath) )
+      {
+         const uint8_t* data = vfs->archive->data(*entry);
+         if( !data ) return nullptr;
+
+         length = entry->length;
+         vfs->files_archived.fetch_add(1, std::memory_order_relaxed);
+         return data;
+      }
+   }
+
+   const std::filesystem::path path = ma_vfs_mmap_resolve(pFilePath);
+   if( path.empty() || !(mapping = rhythm::MappedFile::open(path)) ) return nullptr;
+
+   length = mapping->size;
+   vfs->files_mapped.fetch_add(1, std::memory_order_relaxed);
+   return mapping->data();
+}
+
+ma_result ma_vfs_open_mmap(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile)
+{
+   if( openMode & MA_OPEN_MODE_WRITE ) return MA_NOT_IMPLEMENTED;
+   ma_vfs_mmap_struct* vfs = (ma_vfs_mmap_struct*)pVFS;
+
+   ma_vfs_mmap_file* file_ptr = new ma_vfs_mmap_file; // malloc
+
+   if( vfs->archive && (file_ptr->entry = vfs->archive->find(pFilePath)) )
+   {
+      file_ptr->data = vfs->archive->data(*file_ptr->entry);
+      file_ptr->length = file_ptr->entry->length;
+      vfs->files_archived.fetch_add(1, std::memory_order_relaxed);
+
+      *pFile = (ma_vfs_file)file_ptr;
+      return MA_SUCCESS;
+   }
+
+   const std::filesystem::path path = ma_vfs_mmap_resolve(pFilePath);
+   if( !path.empty() ) file_ptr->mapping = rhythm::MappedFile::open(path);
+
+   // (also covers a file we couldn't map, eg. an empty one)
+   if( !file_ptr->mapping )
+   {
+      ma_result result = ma_vfs_open(vfs->fallback, pFilePath, openMode, &file_ptr->fallback_file);
+      if( result != MA_SUCCESS )
+      {
+         delete file_ptr; // free
+         return result;
+      }
+      vfs->files_fallback.fetch_add(1, std::memory_order_relaxed);
+   }
+   else
+   {
+      file_ptr->data = file_ptr->mapping->data();
+      file_ptr->length = file_ptr->mapping->size;
+      vfs->files_mapped.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   *pFile = (ma_vfs_file)file_ptr;
+
+   return MA_SUCCESS;
+}
+
+ma_result ma_vfs_close_mmap(ma_vfs* pVFS, ma_vfs_file file)
+{
+   if( file == nullptr ) return MA_INVALID_FILE;
+   ma_vfs_mmap_file* file_ptr = get_mmap_file_ptr(file);
+
+   if( file_ptr->fallback_file ) ma_vfs_close(((ma_vfs_mmap_struct*)pVFS)->fallback, file_ptr->fallback_file);
+   delete file_ptr; // free (and unmap)
+
+   return MA_SUCCESS;
+}
+
+ma_result ma_vfs_read_mmap(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead)
+{
+   if( file == nullptr ) return MA_INVALID_FILE;
+   ma_vfs_mmap_file* file_ptr = get_mmap_file_ptr(file);
+
+   if( file_ptr->fallback_file ) return ma_vfs_read(((ma_vfs_mmap_struct*)pVFS)->fallback, file_ptr->fallback_file, pDst, sizeInBytes, pBytesRead);
+
+   const uint64_t length = file_ptr->length;
+   uint64_t bytes_read = ( file_ptr->cursor < length ) ? std::min<uint64_t>(sizeInBytes, length - file_ptr->cursor) : 0;
+
+   if( file_ptr->data ) memcpy(pDst, file_ptr->data + file_ptr->cursor, bytes_read);
+   else
+   {
+      const rhythm::AudioArchive* archive = ((ma_vfs_mmap_struct*)pVFS)->archive;
+      const uint64_t read_ahead_end = file_ptr->read_ahead_start + file_ptr->read_ahead.size();
+      
+      // small reads come out of (and refill) the read-ahead, bigger ones go straight to the archive
+      if( bytes_read < ma_vfs_mmap_file::read_ahead_size )
+      {
+         if( file_ptr->cursor < file_ptr->read_ahead_start || file_ptr->cursor + bytes_read > read_ahead_end )
+         {
+            file_ptr->read_ahead.resize(ma_vfs_mmap_file::read_ahead_size);
+            file_ptr->read_ahead.resize( archive->read(*file_ptr->entry, file_ptr->cursor, file_ptr->read_ahead.data(), ma_vfs_mmap_file::read_ahead_size) );
+            file_ptr->read_ahead_start = file_ptr->cursor;
+         }
+         
+         bytes_read = std::min<uint64_t>(bytes_read, file_ptr->read_ahead.size() - (file_ptr->cursor - file_ptr->read_ahead_start));
+         memcpy(pDst, file_ptr->read_ahead.data() + (file_ptr->cursor - file_ptr->read_ahead_start), bytes_read);
+      }
+      else bytes_read = archive->read(*file_ptr->entry, file_ptr->cursor, pDst, bytes_read);
+   }
+   file_ptr->cursor += bytes_read;
+
+   if( pBytesRead != nullptr ) *pBytesRead = bytes_read;
+   if( bytes_read == 0 && sizeInBytes > 0 ) return MA_AT_END;
+
+   return MA_SUCCESS;
+}
+
+ma_result ma_vfs_seek_mmap(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin)
+{
+   if( file == nullptr ) return MA_INVALID_FILE;
+   ma_vfs_mmap_file* file_ptr = get_mmap_file_ptr(file);
+
+   if( file_ptr->fallback_file ) return ma_vfs_seek(((ma_vfs_mmap_struct*)pVFS)->fallback, file_ptr->fallback_file, offset, origin);
+
+   ma_int64 target_pos = 0;
+
+   if     ( origin == ma_seek_origin_start   ) target_pos = offset;
+   else if( origin == ma_seek_origin_current ) target_pos = (ma_int64)file_ptr->cursor + offset;
+   else if( origin == ma_seek_origin_end     ) target_pos = (ma_int64)file_ptr->length + offset;
+
+   if( target_pos < 0 ) return MA_BAD_SEEK;
+
+   file_ptr->cursor = (uint64_t)target_pos;
+
+   return MA_SUCCESS;
+}
+
+ma_result ma_vfs_tell_mmap(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor)
+{
+   if( file == nullptr ) return MA_INVALID_FILE;
+   ma_vfs_mmap_file* file_ptr = get_mmap_file_ptr(file);
+
+   if( file_ptr->fallback_file ) return ma_vfs_tell(((ma_vfs_mmap_struct*)pVFS)->fallback, file_ptr->fallback_file, pCursor);
+
+   if( pCursor != nullptr ) *pCursor = (ma_int64)file_ptr->cursor;
+
+   return MA_SUCCESS;
+}
+
+ma_result ma_vfs_info_mmap(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo)
+{
+   if( file == nullptr ) return MA_INVALID_FILE;
+   ma_vfs_mmap_file* file_ptr = get_mmap_file_ptr(file);
+
+   if( file_ptr->fallback_file ) return ma_vfs_info(((ma_vfs_mmap_struct*)pVFS)->fallback, file_ptr->fallback_file, pInfo);
+
+   if( pInfo != nullptr ) pInfo->sizeInBytes = file_ptr->length;
+
+   return MA_SUCCESS;
+}
+
+static ma_vfs_callbacks ma_vfs_callbacks_mmap
+{
+    ma_vfs_open_mmap,
+    nullptr,
+    ma_vfs_close_mmap,
+    ma_vfs_read_mmap,
+    nullptr,
+    ma_vfs_seek_mmap,
+    ma_vfs_tell_mmap,
+    ma_vfs_info_mmap
+};
+
+inline ma_vfs_mmap_struct::ma_vfs_mmap_struct() : cb(ma_vfs_callbacks_mmap) {}
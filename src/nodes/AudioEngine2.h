@@ -7,19 +7,35 @@
    TOOD: of course, rename to AudioEngine
 */
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <algorithm>
 #include <map>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string.h>
 
 #include "miniaudio.h"
 #include "ma_vfs_godot.h"
+#include "ma_vfs_mmap.h"
 
 #include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/canvas_layer.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 
 #include "BXCTX.h"
 #include "Track.h"
 #include "Conductor.h"
+#include "AsyncDecode.h"
+#include "PCMCache.h"
+#include "SoundPool.h"
+#include "AudioArchive.h"
+#include "ma_click_node.h"
+#include "ma_crossfade_node.h"
+#include "AudioMonitor.h"
+#include "AudioMonitorOverlay.h"
 
 namespace rhythm
 {
@@ -30,23 +46,96 @@ struct AudioEngine2 : public godot::Node
 
 private:
     public: ma_engine engine; private:
+    // the output device. opened by us rather than by the engine, so that it can be reopened with different settings
+    // without touching the engine (and every sound and node in it, and Conductor's time). see reinit_device()
+    ma_context device_context;
+    ma_device device;
+    bool device_initialized { false };
+    // device settings. 0 is whatever miniaudio picks (periods of 10ms, a low latency profile, and the device's rate)
+    int64_t device_period_size_in_frames { 0 }; // (wins over device_period_size_in_ms)
+    int64_t device_period_size_in_ms { 0 };
+    int64_t device_periods { 0 };
+    bool device_low_latency { true };
+    bool device_exclusive { false };
+    int64_t device_sample_rate { 0 }; // (only when the engine is created, its rate can't change after)
+    // nothing plays: the device is miniaudio's null backend, never started, and the engine only moves when something
+    // renders it (see render). only when the engine is created
+    bool offline { false };
+    static constexpr ma_uint32 render_block_size { 512 }; // (frames per engine read when rendering)
     ma_vfs_godot_struct ma_vfs_godot; // see ma_vfs_godot.h
-    std::list<ma_sound> sounds;
+    int64_t vfs_block_size_kb { 32 };
+    ma_vfs_mmap_struct ma_vfs_mmap; // what everything actually loads through. falls back to ma_vfs_godot (see ma_vfs_mmap.h)
+    // the game's audio, packed into one file (see AudioArchive.h). mounted in _ready, if there is one
+    AudioArchive audio_archive;
+    godot::String audio_archive_path { "res://audio.bxaa" };
+    // only if the archive couldn't be mapped, every file in it is read through this one handle
+    godot::Ref<godot::FileAccess> audio_archive_file;
+    std::mutex audio_archive_mutex;
+    // every ma_sound we've loaded lives in here (see SoundPool.h)
+    SoundPool sound_pool;
+    int64_t sound_pool_budget_mb { 512 };
     
     float volume { 1.0 };
     
     public: godot::Ref<rhythm::Track> current_track; private:
     public: bool playing_track { false }; private:
+    // play_current_track() was called before current track had finished loading, so _process starts it once it has
+    bool play_when_ready { false };
     public: float current_track_pitch { 1.0 }; private:
 
     public: Conductor conductor; private:
+    // published by the audio thread once per period, see AudioClock.h
+    AudioClock clock;
+    // the sound AudioClock reports the cursor of. set by the game thread (only through set_clock_sound), read by the
+    // audio thread
+    std::atomic<ma_sound*> clock_sound { nullptr };
+    // how many engine_process calls are reading clock_sound's sound right now (0 or 1)
+    std::atomic<int32_t> clock_sound_readers { 0 };
     godot::Ref<rhythm::Audio> click;
-    public: bool play_click { false }; private:
-    int next_click_index { 0 };
-    int64_t click_latency { 2000 };
+    // mixes click in on every beat of conductor, from the audio thread (see ma_click_node.h)
+    click_node metronome;
     // used to keep track of where Conductor was when playing a Track, so that it can be switched back to that position
-    // key is the AudioEngine_sounds_index (see Audio.h), and value is the last frame in local time (see Conductor.h)
-    std::map<int, int64_t> conductor_positions;
+    // key is the Track's file path (so that it survives the sound being unloaded), and value is the last frame in local time (see Conductor.h)
+    std::map<godot::String, int64_t> conductor_positions;
+    
+    // decoding a track in the background (see decode_current_track)
+    godot::Ref<rhythm::Audio> decoding_audio;
+    std::unique_ptr<AsyncDecode> async_decode;
+    // decoded tracks are kept on disk, so that they only ever need decoding once (see PCMCache.h)
+    PCMCache pcm_cache;
+    int64_t pcm_cache_size_mb { 1024 };
+    // while a hot-swap is in progress, both the decoded sound and the streamed sound it replaces are loaded (the
+    // streamed one is scheduled to stop on swap_frame). see finish_hot_swap()
+    SoundHandle swapped_in;
+    SoundHandle swapped_out;
+    int64_t swap_frame { 0 };
+    // how far ahead of the audio thread a hot-swap (or a crossfade) is scheduled, at the least (see
+    // get_hot_swap_margin_in_frames)
+    static constexpr int64_t min_hot_swap_margin_in_frames { 4096 };
+    
+    // crossfading from the current track to another (see crossfade_to). the outgoing track keeps playing (and can't
+    // be evicted) until it has faded out, and the incoming one only becomes current_track at crossover_frame
+    crossfade_node crossfader;
+    int64_t crossfade_ms { 500 };
+    godot::Ref<rhythm::Track> crossfade_waiting; // (for its sound to be ready, the current track plays on meanwhile)
+    godot::Ref<rhythm::Track> crossfade_outgoing;
+    godot::Ref<rhythm::Track> crossfade_incoming; // (until it's handed over to)
+    SoundHandle crossfade_voice; // the sound on the incoming bus of the last fade (see ma_crossfade_node.h)
+    ma_uint32 crossfade_bus { 0 }; // (that bus)
+    int64_t crossfade_start_frame { 0 };
+    int64_t crossover_frame { 0 };
+    int64_t crossfade_end_frame { 0 };
+    int64_t crossfade_resume_frame { 0 }; // where the incoming sound starts from
+    
+    // a hit is switching to a track whose sound was already loaded and ready to play (see prefetch)
+    uint64_t prefetch_hits { 0 };
+    uint64_t prefetch_misses { 0 };
+    uint64_t prefetch_loads { 0 };
+    
+    // times every device callback, from the audio thread (see AudioMonitor.h)
+    AudioMonitor audio_monitor;
+    // only while show_audio_overlay is on
+    godot::CanvasLayer* audio_overlay { nullptr };
 
 protected:
     static void _bind_methods()
@@ -68,15 +157,85 @@ protected:
         godot::ClassDB::bind_method(godot::D_METHOD("set_current_track_pitch", "p_track_pitch"), &rhythm::AudioEngine2::set_current_track_pitch);
         ADD_PROPERTY(godot::PropertyInfo(godot::Variant::FLOAT, "current_track_pitch"), "set_current_track_pitch", "get_current_track_pitch");
 
+        // crossfade
+        godot::ClassDB::bind_method(godot::D_METHOD("get_crossfade_ms"), &rhythm::AudioEngine2::get_crossfade_ms);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_crossfade_ms", "p_crossfade_ms"), &rhythm::AudioEngine2::set_crossfade_ms);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "crossfade_ms"), "set_crossfade_ms", "get_crossfade_ms");
+        godot::ClassDB::bind_method(godot::D_METHOD("crossfade_to", "p_track"), &rhythm::AudioEngine2::crossfade_to);
+        godot::ClassDB::bind_method(godot::D_METHOD("is_crossfading"), &rhythm::AudioEngine2::is_crossfading);
+        
         // click
         godot::ClassDB::bind_method(godot::D_METHOD("get_click"), &rhythm::AudioEngine2::get_click);
         godot::ClassDB::bind_method(godot::D_METHOD("set_click", "p_track"), &rhythm::AudioEngine2::set_click);
         ADD_PROPERTY(godot::PropertyInfo(godot::Variant::OBJECT, "click", godot::PROPERTY_HINT_RESOURCE_TYPE, "Audio"), "set_click", "get_click");
-
-        // click_latency
-        godot::ClassDB::bind_method(godot::D_METHOD("get_click_latency"), &rhythm::AudioEngine2::get_click_latency);
-        godot::ClassDB::bind_method(godot::D_METHOD("set_click_latency", "p_click_latency"), &rhythm::AudioEngine2::set_click_latency);
-        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "click_latency"), "set_click_latency", "get_click_latency");
+        
+        // pcm_cache_size_mb
+        godot::ClassDB::bind_method(godot::D_METHOD("get_pcm_cache_size_mb"), &rhythm::AudioEngine2::get_pcm_cache_size_mb);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_pcm_cache_size_mb", "p_pcm_cache_size_mb"), &rhythm::AudioEngine2::set_pcm_cache_size_mb);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "pcm_cache_size_mb"), "set_pcm_cache_size_mb", "get_pcm_cache_size_mb");
+        
+        // sound_pool_budget_mb
+        godot::ClassDB::bind_method(godot::D_METHOD("get_sound_pool_budget_mb"), &rhythm::AudioEngine2::get_sound_pool_budget_mb);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_sound_pool_budget_mb", "p_sound_pool_budget_mb"), &rhythm::AudioEngine2::set_sound_pool_budget_mb);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "sound_pool_budget_mb"), "set_sound_pool_budget_mb", "get_sound_pool_budget_mb");
+        
+        // vfs_block_size_kb
+        godot::ClassDB::bind_method(godot::D_METHOD("get_vfs_block_size_kb"), &rhythm::AudioEngine2::get_vfs_block_size_kb);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_vfs_block_size_kb", "p_vfs_block_size_kb"), &rhythm::AudioEngine2::set_vfs_block_size_kb);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "vfs_block_size_kb"), "set_vfs_block_size_kb", "get_vfs_block_size_kb");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_vfs_stats"), &rhythm::AudioEngine2::get_vfs_stats);
+        godot::ClassDB::bind_method(godot::D_METHOD("benchmark_vfs", "p_path", "p_iterations"), &rhythm::AudioEngine2::benchmark_vfs);
+        
+        // audio_archive_path
+        godot::ClassDB::bind_method(godot::D_METHOD("get_audio_archive_path"), &rhythm::AudioEngine2::get_audio_archive_path);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_audio_archive_path", "p_audio_archive_path"), &rhythm::AudioEngine2::set_audio_archive_path);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::STRING, "audio_archive_path", godot::PROPERTY_HINT_FILE, "*.bxaa"), "set_audio_archive_path", "get_audio_archive_path");
+        
+        // decode progress
+        godot::ClassDB::bind_method(godot::D_METHOD("get_decode_progress"), &rhythm::AudioEngine2::get_decode_progress);
+        
+        // prefetch
+        godot::ClassDB::bind_method(godot::D_METHOD("prefetch", "p_audio"), &rhythm::AudioEngine2::prefetch);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_prefetch_stats"), &rhythm::AudioEngine2::get_prefetch_stats);
+        
+        // device
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_period_size_in_frames"), &rhythm::AudioEngine2::get_device_period_size_in_frames);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_period_size_in_frames", "p_device_period_size_in_frames"), &rhythm::AudioEngine2::set_device_period_size_in_frames);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "device_period_size_in_frames"), "set_device_period_size_in_frames", "get_device_period_size_in_frames");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_period_size_in_ms"), &rhythm::AudioEngine2::get_device_period_size_in_ms);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_period_size_in_ms", "p_device_period_size_in_ms"), &rhythm::AudioEngine2::set_device_period_size_in_ms);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "device_period_size_in_ms"), "set_device_period_size_in_ms", "get_device_period_size_in_ms");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_periods"), &rhythm::AudioEngine2::get_device_periods);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_periods", "p_device_periods"), &rhythm::AudioEngine2::set_device_periods);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "device_periods"), "set_device_periods", "get_device_periods");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_low_latency"), &rhythm::AudioEngine2::get_device_low_latency);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_low_latency", "p_device_low_latency"), &rhythm::AudioEngine2::set_device_low_latency);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::BOOL, "device_low_latency"), "set_device_low_latency", "get_device_low_latency");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_exclusive"), &rhythm::AudioEngine2::get_device_exclusive);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_exclusive", "p_device_exclusive"), &rhythm::AudioEngine2::set_device_exclusive);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::BOOL, "device_exclusive"), "set_device_exclusive", "get_device_exclusive");
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_sample_rate"), &rhythm::AudioEngine2::get_device_sample_rate);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_device_sample_rate", "p_device_sample_rate"), &rhythm::AudioEngine2::set_device_sample_rate);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "device_sample_rate"), "set_device_sample_rate", "get_device_sample_rate");
+        godot::ClassDB::bind_method(godot::D_METHOD("reinit_device"), &rhythm::AudioEngine2::reinit_device);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_device_info"), &rhythm::AudioEngine2::get_device_info);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_output_latency_in_frames"), &rhythm::AudioEngine2::get_output_latency_in_frames);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_output_latency_in_ms"), &rhythm::AudioEngine2::get_output_latency_in_ms);
+        
+        // offline
+        godot::ClassDB::bind_method(godot::D_METHOD("get_offline"), &rhythm::AudioEngine2::get_offline);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_offline", "p_offline"), &rhythm::AudioEngine2::set_offline);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::BOOL, "offline"), "set_offline", "get_offline");
+        godot::ClassDB::bind_method(godot::D_METHOD("render_to_buffer", "p_seconds"), &rhythm::AudioEngine2::render_to_buffer);
+        godot::ClassDB::bind_method(godot::D_METHOD("render_to_wav", "p_path", "p_seconds"), &rhythm::AudioEngine2::render_to_wav);
+        
+        // audio thread stats
+        godot::ClassDB::bind_method(godot::D_METHOD("get_audio_thread_stats"), &rhythm::AudioEngine2::get_audio_thread_stats);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_audio_thread_loads"), &rhythm::AudioEngine2::get_audio_thread_loads);
+        godot::ClassDB::bind_method(godot::D_METHOD("reset_audio_thread_stats"), &rhythm::AudioEngine2::reset_audio_thread_stats);
+        godot::ClassDB::bind_method(godot::D_METHOD("get_show_audio_overlay"), &rhythm::AudioEngine2::get_show_audio_overlay);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_show_audio_overlay", "p_show_audio_overlay"), &rhythm::AudioEngine2::set_show_audio_overlay);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::BOOL, "show_audio_overlay"), "set_show_audio_overlay", "get_show_audio_overlay");
     }
 
 public:
@@ -84,30 +243,75 @@ public:
     
     void _exit_tree() override
     {
+        async_decode.reset(); // (cancels the decode, if there is one)
+        decoding_audio.unref();
+        finish_hot_swap(true);
+        
         pause_current_track();
+        set_clock_sound(nullptr);
 
-        for(ma_sound& sound : sounds) ma_sound_uninit(&sound);
-        sounds.clear();
+        // the device goes first, so the audio thread is gone before any sound (or the engine) is. ma_engine_uninit
+        // then stops it again, which does nothing to a device that's uninitialized (or that the last reinit_device
+        // couldn't open)
+        if( device_initialized ) ma_device_uninit(&device);
+        device_initialized = false;
 
+        sound_pool.clear();
+        metronome.uninit();
+        crossfader.uninit();
         ma_engine_uninit(&engine);
+        ma_context_uninit(&device_context);
+        
+        ma_vfs_mmap.archive = nullptr;
+        audio_archive.unmount();
+        audio_archive_file.unref();
     }
 
     void _ready() override
     {
+        mount_audio_archive();
+        
         // miniaudio
+        const ma_backend null_backend = ma_backend_null;
+        if( ma_context_init(offline ? &null_backend : nullptr, offline ? 1 : 0, nullptr, &device_context) != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::_ready] failed to initialize miniaudio context!");
+            return;
+        }
+        if( !init_device(static_cast<ma_uint32>(device_sample_rate), 0) )
+        {
+            godot::print_error("[AudioEngine2::_ready] failed to initialize audio device!");
+            return;
+        }
+        
         ma_engine_config engine_config = ma_engine_config_init();
-        engine_config.pResourceManagerVFS = (ma_vfs*)&ma_vfs_godot;
+        ma_vfs_mmap.fallback = (ma_vfs*)&ma_vfs_godot;
+        engine_config.pResourceManagerVFS = (ma_vfs*)&ma_vfs_mmap;
+        engine_config.pDevice = &device;
+        engine_config.noAutoStart = offline ? MA_TRUE : MA_FALSE;
+        engine_config.onProcess = AudioEngine2::engine_process;
+        engine_config.pProcessUserData = this;
 
         if( ma_engine_init(&engine_config, &engine) != MA_SUCCESS )
         {
             godot::print_error("[AudioEngine2::_ready] failed to initialize miniaudio engine!");
             return;
         }
+        godot::print_line("[AudioEngine2::_ready] ", describe_device(), offline ? " (offline, only rendering)" : "");
         
         ma_engine_set_volume(&engine, volume);
+        if( crossfader.init(&engine) != MA_SUCCESS ) godot::print_error("[AudioEngine2::_ready] failed to initialize the crossfader!");
+        
+        pcm_cache.directory = std::filesystem::u8path( godot::ProjectSettings::get_singleton()->globalize_path("user://pcm_cache").utf8().get_data() );
+        set_pcm_cache_size_mb(pcm_cache_size_mb);
+        set_sound_pool_budget_mb(sound_pool_budget_mb);
+        
+        clock.sample_rate = ma_engine_get_sample_rate(&engine);
+        conductor.clock = &clock;
+        audio_monitor.sample_rate = ma_engine_get_sample_rate(&engine);
         
         // click 
-        if(click.is_valid()) load_audio(click);
+        if(click.is_valid()) load_click();
         else godot::print_line("[AudioEngine2::_ready] tried to load click Audio but one was not set. please set one in the inspector!");
         
         // current track
@@ -125,13 +329,24 @@ public:
     
     void _process(double delta) override
     {
-        if(!current_track.is_valid() || !playing_track || !current_track->loaded) return;
-        if(ma_sound_at_end(current_track->sound))
+        // free whatever schedules the click node is done with
+        metronome.collect();
+        audio_monitor.drain();
+        
+        process_async_decode();
+        finish_hot_swap(false);
+        process_crossfade();
+        
+        if( play_when_ready && is_ready(current_track) ) play_current_track();
+        
+        if(!current_track.is_valid() || !playing_track || !is_loaded(current_track)) return;
+        // (a track fading out is allowed to end, the one fading in takes over)
+        if(!crossfade_outgoing.is_valid() && ma_sound_at_end(sound_of(current_track)))
         {
             godot::print_line("[AudioEngine2::_process] song ended!");
 
             pause_current_track();
-            conductor_positions.erase(current_track->AudioEngine2_sounds_index);
+            conductor_positions.erase(current_track->get_file_path());
             set_current_track_progress_in_frames(0);
 
             return;
@@ -139,46 +354,382 @@ public:
         
         /* track is playing */
 
-        conductor.process(ma_engine_get_time_in_pcm_frames(&engine));
+        conductor.process(conductor.get_global_current_frame());
+    }
+    
+    /* AUDIO THREAD */
+    
+    // the device's data callback: what miniaudio would do (render the engine into the device's buffer), timed
+    static void device_data_callback(ma_device* pDevice, void* pFramesOut, const void* pFramesIn, ma_uint32 frameCount)
+    {
+        AudioEngine2* self = static_cast<AudioEngine2*>(pDevice->pUserData);
         
-        // play click sound based of conductor (only audible if play_click is true)
-        const Conductor& c = conductor;
-        const int next_beat_index = c.next_beat_index;
-        const godot::PackedInt64Array& beats = c.beats;
-        const int64_t global_current_frame = ma_engine_get_time_in_pcm_frames(&engine);
-        const int64_t local_current_frame = c.get_local_current_frame(global_current_frame);
+        const int64_t start = self->audio_monitor.begin();
+        ma_engine_read_pcm_frames(&self->engine, pFramesOut, frameCount, nullptr);
+        self->audio_monitor.end(start, frameCount);
+    }
+    
+    // miniaudio calls this at the end of every ma_engine_read_pcm_frames(), i.e. once per device period
+    static void engine_process(void* pUserData, float* pFramesOut, ma_uint64 frameCount)
+    {
+        AudioEngine2* self = static_cast<AudioEngine2*>(pUserData);
         
-        if( next_click_index < beats.size() )
+        AudioClock::Snapshot snapshot;
+        snapshot.engine_frame = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&self->engine) );
+        snapshot.host_time_ns = AudioClock::host_now_ns();
+        snapshot.period_in_frames = static_cast<int64_t>(frameCount);
+        
+        // (counted as a reader before loading the sound, see set_clock_sound)
+        self->clock_sound_readers.fetch_add(1, std::memory_order_seq_cst);
+        ma_sound* sound = self->clock_sound.load(std::memory_order_seq_cst);
+        ma_uint64 cursor;
+        if( sound && ma_sound_get_cursor_in_pcm_frames(sound, &cursor) == MA_SUCCESS ) snapshot.sound_cursor = static_cast<int64_t>(cursor);
+        self->clock_sound_readers.fetch_sub(1, std::memory_order_seq_cst);
+        
+        self->clock.publish(snapshot);
+    }
+    
+    /*
+        GAME THREAD ONLY! makes sound the one AudioClock follows. once this returns the audio thread can't be reading
+        the last one anymore, so it can be freed: either engine_process counted itself as a reader before the store
+        (and this waits for it to finish, which is one cursor read), or it loads the new sound. ma_node_uninit only
+        waits for the node graph to let go of a sound, not for onProcess, which is why this is needed at all
+    */
+    void set_clock_sound(ma_sound* sound)
+    {
+        clock_sound.store(sound, std::memory_order_seq_cst);
+        while( clock_sound_readers.load(std::memory_order_seq_cst) != 0 ) std::this_thread::yield();
+    }
+    
+    /* DEVICE */
+    
+    // opens the output device with the current settings (not started). sample_rate and channels are what the engine
+    // renders at (0 for the device's own). if exclusive mode isn't available, falls back to shared
+    bool init_device(const ma_uint32 sample_rate, const ma_uint32 channels)
+    {
+        ma_device_config device_config = ma_device_config_init(ma_device_type_playback);
+        device_config.playback.format = ma_format_f32;
+        device_config.playback.channels = channels;
+        device_config.playback.shareMode = device_exclusive ? ma_share_mode_exclusive : ma_share_mode_shared;
+        device_config.sampleRate = sample_rate;
+        device_config.periodSizeInFrames = static_cast<ma_uint32>( std::max<int64_t>(device_period_size_in_frames, 0) );
+        device_config.periodSizeInMilliseconds = static_cast<ma_uint32>( std::max<int64_t>(device_period_size_in_ms, 0) );
+        device_config.periods = static_cast<ma_uint32>( std::max<int64_t>(device_periods, 0) );
+        device_config.performanceProfile = device_low_latency ? ma_performance_profile_low_latency : ma_performance_profile_conservative;
+        device_config.dataCallback = AudioEngine2::device_data_callback;
+        device_config.pUserData = this;
+        // (like the engine's own device: it writes every frame, and clips itself)
+        device_config.noPreSilencedOutputBuffer = MA_TRUE;
+        device_config.noClip = MA_TRUE;
+        
+        ma_result result = ma_device_init(&device_context, &device_config, &device);
+        if( result != MA_SUCCESS && device_exclusive )
         {
-            const int64_t global_next_beat_frame = c.global_start_frame + static_cast<int64_t>( beats[next_click_index] / c.pitch );
-
-            if( global_current_frame >= global_next_beat_frame - click_latency )
+            godot::print_error("[AudioEngine2::init_device] couldn't open the device in exclusive mode (", ma_result_description(result), "), falling back to shared mode");
+            device_config.playback.shareMode = ma_share_mode_shared;
+            result = ma_device_init(&device_context, &device_config, &device);
+        }
+        if( result != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::init_device] couldn't open the device: ", ma_result_description(result));
+            return false;
+        }
+        
+        device_initialized = true;
+        return true;
+    }
+    
+    // reopens the device with the current settings, while the engine keeps going. the engine (and so every sound,
+    // Conductor, and AudioClock) is only read by the device, so its time just stops for as long as this takes, and
+    // carries on from the same frame once the new device starts
+    void reinit_device()
+    {
+        if( !is_node_ready() ) return;
+        
+        const ma_uint32 sample_rate = ma_engine_get_sample_rate(&engine);
+        const ma_uint32 channels = ma_engine_get_channels(&engine);
+        if( device_sample_rate > 0 && device_sample_rate != sample_rate )
+            godot::print_line("[AudioEngine2::reinit_device] device_sample_rate only applies when the engine is created, so the device stays at ", sample_rate, " Hz until then");
+        
+        if( device_initialized ) ma_device_uninit(&device); // (stops it, so the audio thread is gone after this)
+        device_initialized = false;
+        
+        hold_clock();
+        
+        if( !init_device(sample_rate, channels) )
+        {
+            // go back to what miniaudio picks, rather than have no sound at all
+            godot::print_error("[AudioEngine2::reinit_device] falling back to the default device settings");
+            const int64_t frames = device_period_size_in_frames, ms = device_period_size_in_ms, periods = device_periods;
+            const bool exclusive = device_exclusive;
+            device_period_size_in_frames = device_period_size_in_ms = device_periods = 0;
+            device_exclusive = false;
+            const bool ok = init_device(sample_rate, channels);
+            device_period_size_in_frames = frames; device_period_size_in_ms = ms; device_periods = periods;
+            device_exclusive = exclusive;
+            
+            if( !ok )
             {
-                if( play_click )
-                {
-                    ma_sound_seek_to_pcm_frame(click->sound, 0);
-                    ma_sound_set_start_time_in_pcm_frames(click->sound, global_next_beat_frame - click_latency);
-                    ma_sound_start(click->sound);
-                }
-
-                next_click_index++;
+                godot::print_error("[AudioEngine2::reinit_device] couldn't open any device, there will be no sound!");
+                return; // (device_initialized stays false, see _exit_tree)
             }
         }
+        
+        if( !offline && ma_device_start(&device) != MA_SUCCESS ) godot::print_error("[AudioEngine2::reinit_device] couldn't start the device!");
+        
+        godot::print_line("[AudioEngine2::reinit_device] ", describe_device());
+    }
+    
+    // GAME THREAD, WITH NO AUDIO THREAD RUNNING! re-anchors the clock on the engine's time right now, with nothing
+    // to extrapolate over (so it holds there until the next period), and forgets when the last callback was, since
+    // nothing rendered in between
+    void hold_clock()
+    {
+        audio_monitor.last_start_ns = 0;
+        AudioClock::Snapshot snapshot = clock.read();
+        snapshot.engine_frame = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) );
+        snapshot.host_time_ns = AudioClock::host_now_ns();
+        snapshot.period_in_frames = 0;
+        clock.publish(snapshot);
+    }
+    
+    // how long from the audio thread rendering a frame until it's heard, as far as the device tells us: every period
+    // of its buffer (it's the least the output can lag behind, the hardware and OS mixer add their own on top)
+    // in engine frames, so it can be subtracted from Conductor's frames (eg. for judgement offsets)
+    int64_t get_output_latency_in_frames() const
+    {
+        if( !device_initialized || device.playback.internalSampleRate == 0 ) return 0;
+        
+        const int64_t internal_frames = int64_t(device.playback.internalPeriodSizeInFrames) * device.playback.internalPeriods;
+        return internal_frames * device.sampleRate / device.playback.internalSampleRate;
+    }
+    double get_output_latency_in_ms() const
+    {
+        if( !device_initialized || device.sampleRate == 0 ) return 0.0;
+        return get_output_latency_in_frames() * 1000.0 / device.sampleRate;
+    }
+    
+    // the engine's time only moves a whole device period at a time, and the audio thread may already be partway into
+    // rendering the next one, so anything scheduled has to be at least that far ahead to not be late. two periods,
+    // so a big period (or a device reopened with one) can't eat the whole margin
+    int64_t get_hot_swap_margin_in_frames() const
+    {
+        if( !device_initialized || device.playback.internalSampleRate == 0 ) return min_hot_swap_margin_in_frames;
+        
+        const int64_t period = int64_t(device.playback.internalPeriodSizeInFrames) * device.sampleRate / device.playback.internalSampleRate;
+        return std::max(min_hot_swap_margin_in_frames, 2*period);
+    }
+    
+    godot::Dictionary get_device_info() const
+    {
+        godot::Dictionary info;
+        if( !device_initialized ) return info;
+        
+        info["backend"] = ma_get_backend_name(device_context.backend);
+        info["offline"] = offline;
+        info["name"] = device.playback.name;
+        info["exclusive"] = ( device.playback.shareMode == ma_share_mode_exclusive );
+        info["sample_rate"] = (int64_t)device.sampleRate;
+        info["internal_sample_rate"] = (int64_t)device.playback.internalSampleRate;
+        info["channels"] = (int64_t)device.playback.channels;
+        info["period_size_in_frames"] = (int64_t)device.playback.internalPeriodSizeInFrames;
+        info["periods"] = (int64_t)device.playback.internalPeriods;
+        info["output_latency_in_frames"] = get_output_latency_in_frames();
+        info["output_latency_in_ms"] = get_output_latency_in_ms();
+        
+        return info;
+    }
+    
+    godot::String describe_device() const
+    {
+        if( !device_initialized ) return "no device";
+        
+        return godot::String("'") + device.playback.name + "' (" + ma_get_backend_name(device_context.backend) + ( device.playback.shareMode == ma_share_mode_exclusive ? ", exclusive" : ", shared" )
+            + ") @ " + godot::String::num_int64(device.playback.internalSampleRate) + " Hz, " + godot::String::num_int64(device.playback.internalPeriods) + " periods of "
+            + godot::String::num_int64(device.playback.internalPeriodSizeInFrames) + " frames, " + godot::String::num(get_output_latency_in_ms(), 1) + "ms output latency";
+    }
+    
+    /* RENDERING */
+    
+    // renders frame_count frames of the whole mix (the current track, the click, the dsp graph, anything playing on
+    // the engine) on this thread, as fast as it can, handing each block to sink(frames, count). the device is stopped
+    // for the duration, and the game thread's side of things (Conductor, the click's schedules, hot-swaps) is driven
+    // by the frames rendered instead of by _process, so the result is exactly what would've been heard
+    template<typename Sink>
+    void render(const ma_uint64 frame_count, Sink&& sink)
+    {
+        const bool was_running = device_initialized && ma_device_is_started(&device);
+        if( was_running ) ma_device_stop(&device);
+        
+        if( current_track.is_valid() && is_loaded(current_track) && !is_decoded(current_track) )
+            godot::print_line("[AudioEngine2::render] '", current_track->get_title(), "' is streamed, so it can fall behind a render this fast. decode_current_track() first to keep it in sync");
+        
+        const ma_uint32 channels = ma_engine_get_channels(&engine);
+        std::vector<float> block(size_t(render_block_size) * channels);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        
+        for( ma_uint64 rendered = 0; rendered < frame_count; )
+        {
+            const ma_uint32 count = static_cast<ma_uint32>( std::min<ma_uint64>(render_block_size, frame_count - rendered) );
+            ma_engine_read_pcm_frames(&engine, block.data(), count, nullptr);
+            sink(block.data(), count);
+            rendered += count;
+            
+            conductor.process(static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) ));
+            metronome.collect();
+            finish_hot_swap(false);
+            process_crossfade();
+        }
+        
+        hold_clock();
+        
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double rendered_seconds = double(frame_count) / ma_engine_get_sample_rate(&engine);
+        godot::print_line("[AudioEngine2::render] rendered ", rendered_seconds, "s in ", seconds, "s (", seconds > 0.0 ? rendered_seconds/seconds : 0.0, "x realtime)");
+        
+        if( was_running && ma_device_start(&device) != MA_SUCCESS ) godot::print_error("[AudioEngine2::render] couldn't restart the device!");
+    }
+    
+    // p_seconds of the mix, interleaved (see render)
+    godot::PackedFloat32Array render_to_buffer(const double p_seconds)
+    {
+        godot::PackedFloat32Array pcm;
+        if( !is_node_ready() || p_seconds <= 0.0 ) return pcm;
+        
+        const ma_uint64 frame_count = static_cast<ma_uint64>( p_seconds * ma_engine_get_sample_rate(&engine) );
+        const ma_uint32 channels = ma_engine_get_channels(&engine);
+        pcm.resize(frame_count * channels);
+        
+        float* out = pcm.ptrw();
+        render(frame_count, [&](const float* frames, ma_uint32 count)
+        {
+            memcpy(out, frames, sizeof(float) * count * channels);
+            out += size_t(count) * channels;
+        });
+        
+        return pcm;
+    }
+    
+    // p_seconds of the mix, as a 32 bit float wav at p_path (see render)
+    bool render_to_wav(const godot::String& p_path, const double p_seconds)
+    {
+        if( !is_node_ready() || p_seconds <= 0.0 ) return false;
+        
+        const godot::CharString path = godot::ProjectSettings::get_singleton()->globalize_path(p_path).utf8();
+        ma_encoder_config encoder_config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, ma_engine_get_channels(&engine), ma_engine_get_sample_rate(&engine));
+        ma_encoder encoder;
+        if( ma_encoder_init_file(path.get_data(), &encoder_config, &encoder) != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::render_to_wav] couldn't open '", p_path, "' for writing");
+            return false;
+        }
+        
+        bool ok = true;
+        const ma_uint64 frame_count = static_cast<ma_uint64>( p_seconds * ma_engine_get_sample_rate(&engine) );
+        render(frame_count, [&](const float* frames, ma_uint32 count)
+        {
+            ma_uint64 written = 0;
+            if( ma_encoder_write_pcm_frames(&encoder, frames, count, &written) != MA_SUCCESS || written != count ) ok = false;
+        });
+        ma_encoder_uninit(&encoder);
+        
+        if( !ok ) godot::print_error("[AudioEngine2::render_to_wav] couldn't write all of '", p_path, "'");
+        return ok;
     }
     
     /* PUBLIC METHODS */
     
-    bool load_sound(const godot::StringName& path, bool async=true, ma_sound* at=nullptr)
+    /*
+        mounts audio_archive_path, so that every file in it opens straight out of the archive (see ma_vfs_mmap.h).
+        the archive is mapped if it's on the real filesystem (running from the editor), and otherwise read through
+        one FileAccess (from inside the .pck). there not being an archive at all is fine, files are opened one by one
+        
+        a mapped archive can be older than the files it was packed from (they're right there when running from the
+        editor, and may have been edited since), so any of its files that differ in size from theirs, or that were
+        modified after it was packed, are dropped from it, and opened from disk instead
+    */
+    void mount_audio_archive()
     {
-        ma_sound* sound = at;
-
-        if( at == nullptr ) // if we're initializing a new sound
+        if( audio_archive_path.is_empty() || !godot::FileAccess::file_exists(audio_archive_path) ) return;
+        
+        const godot::String global_path = godot::ProjectSettings::get_singleton()->globalize_path(audio_archive_path);
+        bool mounted = audio_archive.mount( MappedFile::open(std::filesystem::u8path(global_path.utf8().get_data())) );
+        
+        if( !mounted )
         {
-            sounds.emplace_back();
-            sound = &sounds.back();
+            audio_archive_file = godot::FileAccess::open(audio_archive_path, godot::FileAccess::READ);
+            if( audio_archive_file.is_valid() )
+            {
+                auto read_at = [this](uint64_t offset, void* dst, uint64_t size) -> uint64_t
+                {
+                    std::lock_guard<std::mutex> lock(audio_archive_mutex); // (the resource manager reads from its own threads)
+                    audio_archive_file->seek(offset);
+                    return audio_archive_file->get_buffer(static_cast<uint8_t*>(dst), size);
+                };
+                mounted = audio_archive.mount(read_at, audio_archive_file->get_length());
+            }
         }
         
+        if( !mounted )
+        {
+            godot::print_error("[AudioEngine2::mount_audio_archive] '", audio_archive_path, "' isn't a valid audio archive! (try rebuilding it with tools/pack_audio.py)");
+            audio_archive_file.unref();
+            return;
+        }
+        
+        if( !audio_archive_file.is_valid() )
+        {
+            const std::filesystem::path project_path = std::filesystem::u8path( godot::ProjectSettings::get_singleton()->globalize_path("res://").utf8().get_data() );
+            std::error_code archive_error;
+            const auto archive_time = std::filesystem::last_write_time(std::filesystem::u8path(global_path.utf8().get_data()), archive_error);
+            
+            const size_t stale = audio_archive.drop_if([&](const AudioArchive::Entry& entry)
+            {
+                const std::filesystem::path source = project_path / std::filesystem::u8path(std::string(audio_archive.path_of(entry)));
+                std::error_code error;
+                const uintmax_t size = std::filesystem::file_size(source, error);
+                if( error ) return false; // (no source, so the archive is all there is)
+                if( size != entry.length ) return true;
+                
+                const auto time = std::filesystem::last_write_time(source, error);
+                return !error && !archive_error && time > archive_time;
+            });
+            if( stale ) godot::print_error("[AudioEngine2::mount_audio_archive] ", (int64_t)stale, " files in '", audio_archive_path, "' are out of date, loading them from disk instead (rebuild it with tools/pack_audio.py)");
+        }
+        
+        ma_vfs_mmap.archive = &audio_archive;
+        godot::print_line("[AudioEngine2::mount_audio_archive] mounted '", audio_archive_path, "' (", (int64_t)audio_archive.size(), " files, ", audio_archive_file.is_valid() ? "read" : "mapped", ")");
+    }
+    
+    void load_click()
+    {
+        metronome.uninit();
+        
+        godot::CharString path_charstring = godot::String(click->get_file_path()).utf8();
+        if( metronome.init(&engine, (ma_vfs*)&ma_vfs_mmap, path_charstring.get_data()) != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::load_click] unable to load click '", click->get_file_path(), "'!");
+            metronome.uninit();
+            return;
+        }
+        
+        metronome.publish(conductor);
+    }
+    
+    // every time conductor changes, the click node needs to know about it
+    void set_conductor_beats(const godot::PackedInt64Array& beats)
+    {
+        conductor.set_beats(ma_engine_get_time_in_pcm_frames(&engine), beats);
+        metronome.publish(conductor);
+    }
+    
+    // loads path into a new slot of the sound pool, or returns an invalid handle if it couldn't
+    SoundHandle load_sound(const godot::StringName& path, bool async=true)
+    {
         godot::CharString path_charstring = godot::String(path).utf8();
+        
+        SoundHandle handle = sound_pool.acquire(path_charstring.get_data());
+        SoundPool::Slot* slot = sound_pool.slot(handle);
 
         // default to async loading, if you need to load the entire sound into memory upfront, use decode_current_track()
         ma_uint32 LOAD_FLAGS = MA_SOUND_FLAG_NO_SPATIALIZATION;
@@ -189,39 +740,160 @@ public:
             godot::print_line("[AudioEngine2::load_sound] loading (decoding) sound in its entirety. (expect a lag spike!)");
         }
 
-        if( ma_sound_init_from_file(&engine, path_charstring.get_data(), LOAD_FLAGS, NULL, NULL, sound) != MA_SUCCESS )
+        if( ma_sound_init_from_file(&engine, path_charstring.get_data(), LOAD_FLAGS, NULL, NULL, &slot->sound) != MA_SUCCESS )
         {
             godot::print_error("[AudioEngine2::load_sound] unable to load ", path, "!");
             
-            if( at == nullptr ) sounds.pop_back();
-            return false;
+            sound_pool.release(handle);
+            return {};
         }
+        slot->initialized = true;
         
-        //godot::print_line("[AudioEngine2::load_sound] ", abs_path, " loaded as track ", (int)(sounds.size()-1), "!");
+        //godot::print_line("[AudioEngine2::load_sound] ", path, " loaded into slot ", (int)handle.index, "!");
         
-        return true;
+        return handle;
     }
     
     bool load_audio(const godot::Ref<rhythm::Audio>& audio)
     {
-        if( audio->loaded )
+        if( is_loaded(audio) )
         {
             //godot::print_line("[AudioEngine2::load_audio] ", audio->get_file_path(), " is already loaded! ignoring ...");
+            sound_pool.touch(audio->sound_handle);
             return true;
         }
-        if( !load_sound(audio->get_file_path()) )
+        
+        SoundHandle handle = load_sound(audio->get_file_path());
+        if( !sound_pool.is_loaded(handle) )
         {
             godot::print_error("[AudioEngine2::load_audio] failed to load audio '", audio->get_file_path(), "'!");
             return false;
         }
         
-        audio->sound = &sounds.back();
-        audio->AudioEngine2_sounds_index = sounds.size()-1;
-        audio->loaded = true;
+        audio->sound_handle = handle;
+        evict_sounds();
 
         return true;
     }
     
+    ma_sound* sound_of(const godot::Ref<rhythm::Audio>& audio) const { return audio.is_valid() ? sound_pool.get(audio->sound_handle) : nullptr; }
+    bool is_loaded(const godot::Ref<rhythm::Audio>& audio) const { return audio.is_valid() && sound_pool.is_loaded(audio->sound_handle); }
+    bool is_decoded(const godot::Ref<rhythm::Audio>& audio) const { return audio.is_valid() && sound_pool.is_decoded(audio->sound_handle); }
+    // whether audio can start playing right away, i.e. the resource manager has finished (asynchronously) loading it
+    bool is_ready(const godot::Ref<rhythm::Audio>& audio) const
+    {
+        if( !is_loaded(audio) ) return false;
+        if( is_decoded(audio) ) return true; // (decoded sounds are plain audio buffers, already in memory)
+        
+        return ma_resource_manager_data_source_result( (ma_resource_manager_data_source*)ma_sound_get_data_source(sound_of(audio)) ) == MA_SUCCESS;
+    }
+    
+    // starts loading audio in the background, so that it's ready to play by the time it becomes the current track.
+    // the resource manager reads the file and sets up its decoder, and we seek it to wherever conductor left off
+    void prefetch(const godot::Ref<rhythm::Audio>& audio)
+    {
+        if( !audio.is_valid() || !is_node_ready() || is_loaded(audio) )
+        {
+            if( audio.is_valid() ) sound_pool.touch(audio->sound_handle); // (still counts as recently used)
+            return;
+        }
+        
+        if( !load_audio(audio) ) return;
+        prefetch_loads++;
+        
+        auto it = conductor_positions.find(audio->get_file_path());
+        if( it != conductor_positions.end() ) ma_sound_seek_to_pcm_frame(sound_of(audio), it->second);
+    }
+    
+    godot::Dictionary get_prefetch_stats() const
+    {
+        godot::Dictionary stats;
+        stats["hits"] = (int64_t)prefetch_hits;
+        stats["misses"] = (int64_t)prefetch_misses;
+        stats["loads"] = (int64_t)prefetch_loads;
+        stats["loaded_sounds"] = (int64_t)sound_pool.used_count();
+        
+        return stats;
+    }
+    
+    // everything AudioMonitor has counted since the last reset, and the load and jitter over the last history_size
+    // callbacks. loads are in percent of the budget (the length of the period in real time)
+    godot::Dictionary get_audio_thread_stats() const
+    {
+        double load_sum = 0.0, load_peak = 0.0, jitter_sum_ms = 0.0;
+        int64_t counted = 0, jitter_counted = 0;
+        audio_monitor.for_each([&](const AudioMonitor::Callback& callback)
+        {
+            if( callback.frames == 0 ) return;
+            load_sum += callback.load;
+            load_peak = std::max<double>(load_peak, callback.load);
+            counted++;
+            if( callback.interval_ns > 0 )
+            {
+                jitter_sum_ms += callback.jitter_ns / 1e6;
+                jitter_counted++;
+            }
+        });
+        
+        godot::PackedInt64Array histogram;
+        for( const auto& bucket : audio_monitor.load_histogram ) histogram.push_back((int64_t)bucket.load(std::memory_order_relaxed));
+        godot::PackedInt64Array jitter_histogram;
+        for( const auto& bucket : audio_monitor.jitter_histogram ) jitter_histogram.push_back((int64_t)bucket.load(std::memory_order_relaxed));
+        
+        const AudioMonitor::Callback& last = audio_monitor.last;
+        godot::Dictionary stats;
+        stats["callbacks"] = (int64_t)audio_monitor.callback_count.load(std::memory_order_relaxed);
+        stats["overruns"] = (int64_t)audio_monitor.overruns.load(std::memory_order_relaxed);
+        stats["late_callbacks"] = (int64_t)audio_monitor.late_callbacks.load(std::memory_order_relaxed);
+        stats["dropped"] = (int64_t)audio_monitor.dropped.load(std::memory_order_relaxed);
+        stats["period_frames"] = (int64_t)last.frames;
+        stats["budget_ms"] = audio_monitor.budget_ns(last.frames) / 1e6;
+        stats["last_duration_ms"] = last.duration_ns / 1e6;
+        stats["worst_duration_ms"] = audio_monitor.worst_duration_ns.load(std::memory_order_relaxed) / 1e6;
+        stats["average_load"] = counted ? load_sum / counted * 100.0 : 0.0;
+        stats["peak_load"] = load_peak * 100.0;
+        stats["load_histogram"] = histogram; // (10% per bucket, the last is everything over 100%)
+        stats["average_jitter_ms"] = jitter_counted ? jitter_sum_ms / jitter_counted : 0.0;
+        stats["worst_jitter_ms"] = audio_monitor.worst_jitter_ns.load(std::memory_order_relaxed) / 1e6;
+        stats["jitter_histogram"] = jitter_histogram; // (10% of a period per bucket, the last is a period or more)
+        
+        return stats;
+    }
+    
+    // the load of each of the last history_size callbacks, oldest first, in percent
+    godot::PackedFloat32Array get_audio_thread_loads() const
+    {
+        godot::PackedFloat32Array loads;
+        audio_monitor.for_each([&](const AudioMonitor::Callback& callback)
+        {
+            if( callback.frames != 0 ) loads.push_back(callback.load * 100.0f);
+        });
+        
+        return loads;
+    }
+    
+    void reset_audio_thread_stats() { audio_monitor.reset(); }
+    
+    // unloads least recently used sounds until the pool is back within budget. never touches the current track,
+    // whatever the audio thread is reading the cursor of, or either side of a hot-swap
+    void evict_sounds()
+    {
+        const SoundHandle current = current_track.is_valid() ? current_track->sound_handle : SoundHandle{};
+        const ma_sound* clocked = clock_sound.load(std::memory_order_acquire);
+        
+        size_t evicted = sound_pool.evict([&](const SoundHandle& handle)
+        {
+            return handle == current || handle == swapped_in || handle == swapped_out || sound_pool.get(handle) == clocked
+                || (crossfade_outgoing.is_valid() && handle == crossfade_outgoing->sound_handle)
+                || (crossfade_incoming.is_valid() && handle == crossfade_incoming->sound_handle)
+                || (crossfade_waiting.is_valid() && handle == crossfade_waiting->sound_handle);
+        });
+        
+        if( evicted > 0 ) godot::print_line("[AudioEngine2::evict_sounds] unloaded ", (int)evicted, " sounds (", (int)sound_pool.used_count(), " still loaded)");
+    }
+    
+    // decodes current track in the background. it keeps streaming until then, and is hot-swapped to the
+    // decoded PCM once that's done (see process_async_decode). use get_decode_progress() to see how far along it is
     void decode_current_track()
     {
         if( !current_track.is_valid() )
@@ -230,50 +902,417 @@ public:
             return;
         }
         
-        if( current_track->decoded )
+        if( is_decoded(current_track) )
         {
             //godot::print_line("[AudioEngine2::decode_current_track] '", current_track->get_title(), "' is already decoded. nothing to do!");
             return;
         }
         
-        bool is_playing = playing_track;
-        int64_t global_current_time = ma_engine_get_time_in_pcm_frames(&engine);
-        pause_current_track();
+        if( async_decode && decoding_audio == current_track ) return; // already on it
         
-        int64_t local_current_time = conductor.get_local_current_frame(global_current_time);
+        async_decode.reset(); // (only one decode at a time, so cancel whatever else was decoding)
         
-        if( current_track->loaded ) ma_sound_uninit(current_track->sound);
-        if( load_sound(current_track->get_file_path(), false, current_track->sound) ) current_track->decoded = true;
+        const godot::String path = current_track->get_file_path();
+        const ma_uint32 sample_rate = ma_engine_get_sample_rate(&engine);
         
-        set_current_track_progress_in_frames(local_current_time);
-        set_current_track_pitch(current_track_pitch);
-        if( is_playing ) play_current_track();
+        // if we've decoded this exact file before, we can map it straight from the pcm cache
+        godot::Ref<godot::FileAccess> file = godot::FileAccess::open(path, godot::FileAccess::READ);
+        const std::string cache_key = PCMCache::key(path.utf8().get_data(), file.is_valid() ? file->get_length() : 0, godot::FileAccess::get_modified_time(path), sample_rate);
+        file.unref();
+        
+        if( std::unique_ptr<PCMCache::Mapping> mapping = pcm_cache.open(cache_key) )
+        {
+            const PCMCache::Header& header = mapping->header();
+            const float* frames = mapping->frames();
+            
+            std::unique_ptr<DecodedAudio> decoded = std::make_unique<DecodedAudio>();
+            decoded->mapping = std::move(mapping);
+            
+            godot::print_line("[AudioEngine2::decode_current_track] '", current_track->get_title(), "' found in the pcm cache!");
+            hot_swap(current_track, std::move(decoded), frames, header.channels, header.sample_rate, header.length_in_frames);
+            return;
+        }
+        
+        decoding_audio = current_track;
+        async_decode = std::make_unique<AsyncDecode>();
+        
+        // mapped (or archived) files are decoded straight out of memory, anything else through the vfs
+        std::unique_ptr<MappedFile> mapping;
+        uint64_t length = 0;
+        if( const uint8_t* data = ma_vfs_mmap_view(&ma_vfs_mmap, path.utf8().get_data(), length, mapping) ) async_decode->decode_in_place(data, length, std::move(mapping));
+        
+        async_decode->start((ma_vfs*)&ma_vfs_mmap, path.utf8().get_data(), sample_rate, &pcm_cache, cache_key);
+        
+        godot::print_line("[AudioEngine2::decode_current_track] decoding '", current_track->get_title(), "' in the background ...");
     }
     
+    // -1 if nothing is decoding, otherwise 0 to 1
+    float get_decode_progress() const { return async_decode ? async_decode->progress.load(std::memory_order_relaxed) : -1.0f; }
+    
     void play_current_track()
     {
-        if(current_track.is_valid() && current_track->loaded && !playing_track)
+        if(current_track.is_valid() && is_loaded(current_track) && !playing_track)
         {
-            ma_sound_start(current_track->sound);
+            // starting before the resource manager is done would leave the sound silent (and its cursor still)
+            // while conductor runs ahead, so wait for it instead
+            if( !is_ready(current_track) )
+            {
+                play_when_ready = true;
+                return;
+            }
+            play_when_ready = false;
+            
+            // only the sound the last crossfade brought in is on the crossfader at full volume. anything else a
+            // crossfade left on it could be on the silent bus, so it plays straight into the endpoint instead
+            ma_sound* sound = sound_of(current_track);
+            if( current_track->sound_handle != crossfade_voice ) ma_node_attach_output_bus(sound, 0, ma_engine_get_endpoint(&engine), 0);
+            ma_sound_start(sound);
             playing_track = true;
             
             conductor.play(ma_engine_get_time_in_pcm_frames(&engine));
+            metronome.publish(conductor);
         } else godot::print_line("[AudioEngine2::play_current_track] nothing to do ...");
     }
     
     void pause_current_track()
     {
-        if(current_track.is_valid() && current_track->loaded && playing_track)
+        finish_hot_swap(true);
+        finish_crossfade(true);
+        play_when_ready = false;
+        
+        if(current_track.is_valid() && is_loaded(current_track) && playing_track)
         {
-            ma_sound_stop(current_track->sound);
+            ma_sound_stop(sound_of(current_track));
             playing_track = false;
 
             conductor.pause(ma_engine_get_time_in_pcm_frames(&engine));
+            metronome.publish(conductor);
         }
     }
 
+    /* CROSSFADING */
+    
+    // switches to p_track without a gap or a hard cut: it starts on a sample-exact engine frame a little ahead, and
+    // crossfades (equal power, over crossfade_ms, see ma_crossfade_node.h) from the current track, which plays on
+    // until it has faded out. Conductor stays on the current track until the crossover (halfway through the fade),
+    // and follows p_track from there. when nothing is playing, it's just set_current_track and play_current_track
+    void crossfade_to(const godot::Ref<rhythm::Track>& p_track)
+    {
+        if( !is_node_ready() || !p_track.is_valid() || !current_track.is_valid() || p_track == current_track || !playing_track || crossfade_ms <= 0 )
+        {
+            set_current_track(p_track);
+            play_current_track();
+            return;
+        }
+        
+        finish_crossfade(true); // (one at a time)
+        finish_hot_swap(true);
+        // (the track we're leaving won't be hot-swapped while it fades out)
+        if( decoding_audio == current_track )
+        {
+            async_decode.reset();
+            decoding_audio.unref();
+        }
+        
+        if( is_ready(p_track) ) prefetch_hits++;
+        else prefetch_misses++;
+        
+        const bool was_loaded = is_loaded(p_track);
+        if( !load_audio(p_track) ) return;
+        // a paused sound remembers where it was, but one that was (re)loaded just now starts back at 0
+        if( !was_loaded )
+        {
+            auto it = conductor_positions.find(p_track->get_file_path());
+            ma_sound_seek_to_pcm_frame(sound_of(p_track), (it != conductor_positions.end()) ? it->second : 0);
+        }
+        
+        // the current track keeps playing until p_track is ready to start (see process_crossfade), rather than
+        // stopping to wait like play_current_track does
+        crossfade_waiting = p_track;
+        process_crossfade();
+    }
+    
+    bool is_crossfading() const { return crossfade_waiting.is_valid() || crossfade_outgoing.is_valid(); }
+    
+    // schedules the crossfade to crossfade_waiting (which has to be ready)
+    void start_crossfade()
+    {
+        godot::Ref<rhythm::Track> track = crossfade_waiting;
+        crossfade_waiting.unref();
+        
+        ma_sound* outgoing = sound_of(current_track);
+        ma_sound* incoming = sound_of(track);
+        if( !playing_track || !outgoing || !incoming )
+        {
+            set_current_track(track);
+            play_current_track();
+            return;
+        }
+        
+        // the outgoing sound goes on the bus the last fade brought its sound in on (it's already there, if that was
+        // this one), and the incoming sound on the other
+        const ma_uint32 incoming_bus = 1 - crossfade_bus;
+        if( crossfade_voice != current_track->sound_handle )
+        {
+            // (the last voice isn't playing, so it goes back on the endpoint rather than being left on a bus that's
+            // about to go silent)
+            if( ma_sound* voice = sound_pool.get(crossfade_voice) ) ma_node_attach_output_bus(voice, 0, ma_engine_get_endpoint(&engine), 0);
+            ma_node_attach_output_bus(outgoing, 0, &crossfader.base, crossfade_bus);
+        }
+        ma_node_attach_output_bus(incoming, 0, &crossfader.base, incoming_bus);
+        
+        const int64_t length = crossfade_ms * ma_engine_get_sample_rate(&engine) / 1000;
+        crossfade_start_frame = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) ) + get_hot_swap_margin_in_frames();
+        crossover_frame = crossfade_start_frame + length/2;
+        crossfade_end_frame = crossfade_start_frame + length;
+        
+        ma_uint64 cursor = 0;
+        ma_sound_get_cursor_in_pcm_frames(incoming, &cursor);
+        crossfade_resume_frame = static_cast<int64_t>(cursor);
+        
+        ma_sound_set_pitch(incoming, current_track_pitch);
+        ma_sound_set_start_time_in_pcm_frames(incoming, crossfade_start_frame);
+        ma_sound_start(incoming);
+        ma_sound_set_stop_time_in_pcm_frames(outgoing, crossfade_end_frame);
+        crossfader.publish(crossfade_start_frame, length, incoming_bus);
+        
+        crossfade_bus = incoming_bus;
+        crossfade_voice = track->sound_handle;
+        crossfade_outgoing = current_track;
+        crossfade_incoming = track;
+        
+        godot::print_line("[AudioEngine2::start_crossfade] '", crossfade_outgoing->get_title(), "' -> '", track->get_title(), "' from frame ", crossfade_start_frame, " over ", length, " frames");
+    }
+    
+    // game thread's side of a crossfade, every _process (or rendered block, see render)
+    void process_crossfade()
+    {
+        crossfader.collect();
+        if( crossfade_waiting.is_valid() && is_ready(crossfade_waiting) ) start_crossfade();
+        if( !crossfade_outgoing.is_valid() ) return;
+        
+        const int64_t now = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) );
+        if( crossfade_incoming.is_valid() && now >= crossover_frame ) hand_over_crossfade(crossfade_start_frame);
+        finish_crossfade(false);
+    }
+    
+    // the incoming track becomes current_track, and Conductor follows it as if it had started (from
+    // crossfade_resume_frame) on start_frame
+    void hand_over_crossfade(const int64_t start_frame)
+    {
+        current_track = crossfade_incoming;
+        crossfade_incoming.unref();
+        set_clock_sound(sound_of(current_track));
+        
+        const int64_t global_current_frame = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) );
+        conductor.seek(start_frame, crossfade_resume_frame);
+        conductor.set_beats(global_current_frame, current_track->get_beats());
+        metronome.publish(conductor);
+    }
+    
+    // stops the outgoing track once it has faded out. force does it now, even if the fade isn't done (e.g. when
+    // pausing, or switching tracks again), handing over to the incoming track first if that hasn't happened yet
+    void finish_crossfade(bool force)
+    {
+        if( force ) crossfade_waiting.unref();
+        if( !crossfade_outgoing.is_valid() ) return;
+        
+        const int64_t now = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) );
+        if( !force && now < crossfade_end_frame ) return;
+        
+        if( crossfade_incoming.is_valid() )
+        {
+            // (if the incoming sound hasn't even started yet, it starts right away)
+            int64_t start_frame = crossfade_start_frame;
+            if( now < crossfade_start_frame )
+            {
+                ma_sound_set_start_time_in_pcm_frames(sound_of(crossfade_incoming), 0);
+                start_frame = now;
+            }
+            hand_over_crossfade(start_frame);
+        }
+        
+        // the outgoing sound is left where it stopped (so that's where it resumes from), and back on the endpoint
+        if( ma_sound* outgoing = sound_of(crossfade_outgoing) )
+        {
+            ma_sound_stop(outgoing);
+            ma_sound_set_stop_time_in_pcm_frames(outgoing, ~(ma_uint64)0);
+            
+            ma_uint64 cursor = 0;
+            ma_sound_get_cursor_in_pcm_frames(outgoing, &cursor);
+            conductor_positions[crossfade_outgoing->get_file_path()] = static_cast<int64_t>(cursor);
+            
+            ma_node_attach_output_bus(outgoing, 0, ma_engine_get_endpoint(&engine), 0);
+        }
+        crossfade_outgoing.unref();
+        
+        evict_sounds();
+    }
+    
+    /* HOT-SWAPPING */
+    
+    // once the background decode is done, swaps its Audio over from the streamed sound to the decoded one
+    void process_async_decode()
+    {
+        if( !async_decode || !async_decode->done.load(std::memory_order_acquire) ) return;
+        
+        async_decode->thread.join();
+        std::unique_ptr<AsyncDecode> decode = std::move(async_decode);
+        godot::Ref<rhythm::Audio> audio = decoding_audio;
+        decoding_audio.unref();
+        
+        if( decode->result != MA_SUCCESS )
+        {
+            if( decode->result != MA_CANCELLED ) godot::print_error("[AudioEngine2::process_async_decode] failed to decode '", audio->get_file_path(), "' (", ma_result_description(decode->result), ")!");
+            return;
+        }
+        
+        std::unique_ptr<DecodedAudio> decoded = std::make_unique<DecodedAudio>();
+        decoded->pcm = std::move(decode->pcm);
+        const float* frames = decoded->pcm.data();
+        
+        hot_swap(audio, std::move(decoded), frames, decode->channels, decode->sample_rate, decode->length_in_frames);
+    }
+    
+    // swaps audio over from its streamed sound to decoded, whose PCM starts at frames
+    void hot_swap(const godot::Ref<rhythm::Audio>& audio, std::unique_ptr<DecodedAudio> decoded, const float* frames, ma_uint32 channels, ma_uint32 sample_rate, ma_uint64 length_in_frames)
+    {
+        if( !is_loaded(audio) || is_decoded(audio) ) return;
+        
+        finish_hot_swap(true); // (one swap at a time)
+        
+        ma_audio_buffer_config buffer_config = ma_audio_buffer_config_init(ma_format_f32, channels, length_in_frames, frames, nullptr);
+        buffer_config.sampleRate = sample_rate;
+        if( ma_audio_buffer_init(&buffer_config, &decoded->buffer) != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::hot_swap] unable to create an audio buffer for '", audio->get_file_path(), "'!");
+            return;
+        }
+        decoded->initialized = true;
+        
+        SoundHandle handle = sound_pool.acquire(godot::String(audio->get_file_path()).utf8().get_data());
+        SoundPool::Slot* slot = sound_pool.slot(handle);
+        slot->decoded = std::move(decoded);
+        if( ma_sound_init_from_data_source(&engine, &slot->decoded->buffer, MA_SOUND_FLAG_NO_SPATIALIZATION, nullptr, &slot->sound) != MA_SUCCESS )
+        {
+            godot::print_error("[AudioEngine2::hot_swap] unable to create a sound for '", audio->get_file_path(), "'!");
+            sound_pool.release(handle);
+            return;
+        }
+        slot->initialized = true;
+        
+        ma_sound* sound = &slot->sound;
+        ma_sound* streamed = sound_of(audio);
+        ma_sound_set_pitch(sound, ma_sound_get_pitch(streamed));
+        ma_sound_set_volume(sound, ma_sound_get_volume(streamed));
+        
+        const AudioClock::Snapshot snapshot = clock.read();
+        if( audio == current_track && playing_track && snapshot.sound_cursor >= 0 )
+        {
+            // the snapshot tells us exactly where the streamed sound was at snapshot.engine_frame, so we can work out
+            // where it will be a little later on, and have the decoded sound take over from there on that exact frame.
+            // the margin counts from now, not the snapshot, which is as old as the last callback (or older, if the
+            // device has stalled)
+            const int64_t now = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) );
+            swap_frame = std::max(now, snapshot.engine_frame) + get_hot_swap_margin_in_frames();
+            const int64_t swap_cursor = snapshot.sound_cursor + static_cast<int64_t>( (swap_frame - snapshot.engine_frame)*current_track_pitch );
+            
+            ma_sound_seek_to_pcm_frame(sound, swap_cursor);
+            ma_sound_set_start_time_in_pcm_frames(sound, swap_frame);
+            ma_sound_start(sound);
+            ma_sound_set_stop_time_in_pcm_frames(streamed, swap_frame);
+        }
+        else
+        {
+            // nothing is playing, so we can swap straight away
+            ma_uint64 cursor = 0;
+            ma_sound_get_cursor_in_pcm_frames(streamed, &cursor);
+            ma_sound_seek_to_pcm_frame(sound, cursor);
+            
+            swap_frame = 0;
+        }
+        
+        swapped_in = handle;
+        swapped_out = audio->sound_handle;
+        audio->sound_handle = handle;
+        if( audio == current_track ) set_clock_sound(sound);
+        
+        godot::print_line("[AudioEngine2::hot_swap] '", audio->get_file_path(), "' decoded, swapping to it on frame ", swap_frame);
+        
+        if( swap_frame == 0 ) finish_hot_swap(true);
+    }
+    
+    // unloads the streamed sound once the decoded one has taken over. force does it now, even if swap_frame hasn't
+    // come yet (e.g. when pausing or seeking, which would otherwise leave the streamed sound playing)
+    void finish_hot_swap(bool force)
+    {
+        if( swapped_out == SoundHandle{} ) return;
+        const bool early = static_cast<int64_t>( ma_engine_get_time_in_pcm_frames(&engine) ) < swap_frame;
+        if( !force && early ) return;
+        
+        if( ma_sound* sound = sound_pool.get(swapped_in) )
+        {
+            // the decoded sound was seeked to where the streamed one would be on swap_frame. that hasn't come yet,
+            // so it takes over from wherever the streamed one actually got to instead
+            ma_sound* streamed = sound_pool.get(swapped_out);
+            ma_uint64 cursor = 0;
+            if( early && streamed && ma_sound_get_cursor_in_pcm_frames(streamed, &cursor) == MA_SUCCESS ) ma_sound_seek_to_pcm_frame(sound, cursor);
+            ma_sound_set_start_time_in_pcm_frames(sound, 0); // (in case we're early, start right away)
+        }
+        sound_pool.release(swapped_out);
+        
+        swapped_in = {};
+        swapped_out = {};
+        
+        evict_sounds(); // (the decoded sound is a lot bigger than the streamed one was)
+    }
+    
     /* GETTERS & SETTERS */
     
+    // device settings. changing any of them while running reopens the device (see reinit_device)
+    int64_t get_device_period_size_in_frames() const { return device_period_size_in_frames; }
+    void set_device_period_size_in_frames(const int64_t p_device_period_size_in_frames) { device_period_size_in_frames = p_device_period_size_in_frames; reinit_device(); }
+    int64_t get_device_period_size_in_ms() const { return device_period_size_in_ms; }
+    void set_device_period_size_in_ms(const int64_t p_device_period_size_in_ms) { device_period_size_in_ms = p_device_period_size_in_ms; reinit_device(); }
+    int64_t get_device_periods() const { return device_periods; }
+    void set_device_periods(const int64_t p_device_periods) { device_periods = p_device_periods; reinit_device(); }
+    bool get_device_low_latency() const { return device_low_latency; }
+    void set_device_low_latency(const bool p_device_low_latency) { device_low_latency = p_device_low_latency; reinit_device(); }
+    bool get_device_exclusive() const { return device_exclusive; }
+    void set_device_exclusive(const bool p_device_exclusive) { device_exclusive = p_device_exclusive; reinit_device(); }
+    int64_t get_device_sample_rate() const { return device_sample_rate; }
+    void set_device_sample_rate(const int64_t p_device_sample_rate) { device_sample_rate = p_device_sample_rate; reinit_device(); }
+    
+    // crossfade_ms
+    int64_t get_crossfade_ms() const { return crossfade_ms; }
+    void set_crossfade_ms(const int64_t p_crossfade_ms) { crossfade_ms = std::max<int64_t>(p_crossfade_ms, 0); }
+    
+    // offline (only used in _ready)
+    bool get_offline() const { return offline; }
+    void set_offline(const bool p_offline) { offline = p_offline; }
+    
+    // show_audio_overlay
+    bool get_show_audio_overlay() const { return audio_overlay != nullptr; }
+    void set_show_audio_overlay(const bool p_show_audio_overlay)
+    {
+        if( p_show_audio_overlay == get_show_audio_overlay() ) return;
+        
+        if( !p_show_audio_overlay )
+        {
+            audio_overlay->queue_free();
+            audio_overlay = nullptr;
+            return;
+        }
+        
+        // (on its own layer, so it's drawn over everything)
+        audio_overlay = memnew(godot::CanvasLayer);
+        audio_overlay->set_layer(128);
+        AudioMonitorOverlay* overlay = memnew(AudioMonitorOverlay);
+        overlay->monitor = &audio_monitor;
+        audio_overlay->add_child(overlay);
+        add_child(audio_overlay, false, INTERNAL_MODE_BACK);
+    }
+    
     // volume
     float get_volume() const { return volume; }
     void set_volume(const float p_volume) { volume = p_volume; if(is_node_ready()) ma_engine_set_volume(&engine, volume); }
@@ -282,30 +1321,36 @@ public:
     godot::Ref<rhythm::Track> get_current_track() const { return current_track; }
     void set_current_track(const godot::Ref<rhythm::Track>& p_current_track)
     {
-        if(current_track.is_valid() && current_track->loaded)
+        if(current_track.is_valid() && is_loaded(current_track))
         {
-            pause_current_track();
+            pause_current_track(); // (also finishes any hot-swap)
             // save last position
-            conductor_positions[current_track->AudioEngine2_sounds_index] = conductor.pause_frame();
+            conductor_positions[current_track->get_file_path()] = conductor.pause_frame();
         }
 
-        const godot::Ref<rhythm::Track>& previous_track = current_track;
         current_track = p_current_track;
         if(is_node_ready())
         {
+            if( is_ready(current_track) ) prefetch_hits++;
+            else prefetch_misses++;
+            
+            const bool was_loaded = is_loaded(current_track);
+            set_clock_sound(nullptr); // (so that the previous track can be unloaded)
             load_audio(current_track);
+            set_clock_sound(sound_of(current_track));
             
             int64_t global_current_frame = ma_engine_get_time_in_pcm_frames(&engine);
             
-            auto it = conductor_positions.find(current_track->AudioEngine2_sounds_index);
+            auto it = conductor_positions.find(current_track->get_file_path());
             int64_t global_resume_frame = (it != conductor_positions.end()) ? it->second : 0;
+            // a paused sound remembers where it was, but one that was (re)loaded just now starts back at 0
+            if( !was_loaded && is_loaded(current_track) ) ma_sound_seek_to_pcm_frame(sound_of(current_track), global_resume_frame);
 
             conductor.seek(global_current_frame, global_resume_frame);
             conductor.set_beats(global_current_frame, current_track->get_beats());
             
             set_current_track_pitch(current_track_pitch);
-            
-            next_click_index = conductor.next_beat_index;
+            metronome.publish(conductor);
         }
     }
     
@@ -317,23 +1362,127 @@ public:
 
         if(is_node_ready() && current_track.is_valid())
         {
-            ma_sound_set_pitch(current_track->sound, current_track_pitch);
+            if( ma_sound* sound = sound_of(current_track) ) ma_sound_set_pitch(sound, current_track_pitch);
             conductor.set_pitch(ma_engine_get_time_in_pcm_frames(&engine), p_current_track_pitch);
+            metronome.publish(conductor);
         }
     }
 
+    // sound_pool_budget_mb
+    int64_t get_sound_pool_budget_mb() const { return sound_pool_budget_mb; }
+    void set_sound_pool_budget_mb(const int64_t p_sound_pool_budget_mb)
+    {
+        sound_pool_budget_mb = std::max<int64_t>(0, p_sound_pool_budget_mb);
+        sound_pool.budget_in_bytes = static_cast<uint64_t>(sound_pool_budget_mb) << 20;
+        if( is_node_ready() ) evict_sounds();
+    }
+    
+    // pcm_cache_size_mb
+    int64_t get_pcm_cache_size_mb() const { return pcm_cache_size_mb; }
+    void set_pcm_cache_size_mb(const int64_t p_pcm_cache_size_mb)
+    {
+        pcm_cache_size_mb = std::max<int64_t>(0, p_pcm_cache_size_mb);
+        pcm_cache.max_size_in_bytes.store(static_cast<uint64_t>(pcm_cache_size_mb) << 20, std::memory_order_relaxed);
+        if( is_node_ready() ) pcm_cache.evict();
+    }
+    
+    // audio_archive_path (only used in _ready)
+    godot::String get_audio_archive_path() const { return audio_archive_path; }
+    void set_audio_archive_path(const godot::String& p_audio_archive_path) { audio_archive_path = p_audio_archive_path; }
+    
+    // vfs_block_size_kb (only applies to files opened from then on)
+    int64_t get_vfs_block_size_kb() const { return vfs_block_size_kb; }
+    void set_vfs_block_size_kb(const int64_t p_vfs_block_size_kb)
+    {
+        vfs_block_size_kb = std::max<int64_t>(1, p_vfs_block_size_kb);
+        ma_vfs_godot.block_size.store(static_cast<size_t>(vfs_block_size_kb) << 10, std::memory_order_relaxed);
+    }
+    
+    // counters of every file the vfs has closed so far (see ma_vfs_godot.h)
+    godot::Dictionary get_vfs_stats() const
+    {
+        godot::Dictionary stats;
+        stats["files_opened"] = (int64_t)ma_vfs_godot.files_opened.load(std::memory_order_relaxed);
+        stats["read_calls"] = (int64_t)ma_vfs_godot.read_calls.load(std::memory_order_relaxed);
+        stats["bytes_read"] = (int64_t)ma_vfs_godot.bytes_read.load(std::memory_order_relaxed);
+        stats["block_hits"] = (int64_t)ma_vfs_godot.block_hits.load(std::memory_order_relaxed);
+        stats["block_misses"] = (int64_t)ma_vfs_godot.block_misses.load(std::memory_order_relaxed);
+        stats["backend_calls"] = (int64_t)ma_vfs_godot.backend_calls.load(std::memory_order_relaxed);
+        stats["files_mapped"] = (int64_t)ma_vfs_mmap.files_mapped.load(std::memory_order_relaxed);
+        stats["files_archived"] = (int64_t)ma_vfs_mmap.files_archived.load(std::memory_order_relaxed);
+        stats["files_fallback"] = (int64_t)ma_vfs_mmap.files_fallback.load(std::memory_order_relaxed);
+        
+        return stats;
+    }
+    
+    /*
+        decodes path in full, p_iterations times, through each vfs (FileAccess, then mmap), and then in place out of
+        memory (if the file can be mapped), and returns how long each took. the decode is the same as AsyncDecode's,
+        so the fastest of these is the throughput a background decode would see. the first iteration of each warms
+        the OS's file cache, so use a few
+    */
+    godot::Dictionary benchmark_vfs(const godot::String& p_path, const int p_iterations)
+    {
+        godot::Dictionary results;
+        if( !is_node_ready() ) return results;
+        
+        const godot::CharString path = p_path.utf8();
+        const ma_uint32 sample_rate = ma_engine_get_sample_rate(&engine);
+        
+        // (data is only for the in place decode, otherwise it goes through vfs)
+        auto benchmark = [&](ma_vfs* vfs, const uint8_t* data, uint64_t length, const char* name)
+        {
+            ma_uint64 frames_decoded = 0;
+            const auto start = std::chrono::steady_clock::now();
+            
+            for( int i = 0; i < p_iterations; i++ )
+            {
+                ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 0, sample_rate);
+                ma_decoder decoder;
+                const ma_result result = data ? ma_decoder_init_memory(data, static_cast<size_t>(length), &decoder_config, &decoder) : ma_decoder_init_vfs(vfs, path.get_data(), &decoder_config, &decoder);
+                if( result != MA_SUCCESS )
+                {
+                    godot::print_error("[AudioEngine2::benchmark_vfs] unable to decode '", p_path, "' through ", name, "!");
+                    return;
+                }
+                
+                std::vector<float> frames(4096*decoder.outputChannels);
+                ma_uint64 frames_read = 0;
+                while( ma_decoder_read_pcm_frames(&decoder, frames.data(), 4096, &frames_read) == MA_SUCCESS && frames_read > 0 ) frames_decoded += frames_read;
+                
+                ma_decoder_uninit(&decoder);
+            }
+            
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const double audio_seconds = static_cast<double>(frames_decoded) / sample_rate;
+            
+            results[godot::String(name) + "_seconds"] = seconds;
+            results[godot::String(name) + "_realtime_factor"] = ( seconds > 0.0 ) ? audio_seconds / seconds : 0.0;
+            godot::print_line("[AudioEngine2::benchmark_vfs] ", name, ": ", audio_seconds, "s of audio in ", seconds, "s (", audio_seconds / seconds, "x realtime)");
+        };
+        
+        benchmark((ma_vfs*)&ma_vfs_godot, nullptr, 0, "godot");
+        benchmark((ma_vfs*)&ma_vfs_mmap, nullptr, 0, "mmap");
+        
+        std::unique_ptr<MappedFile> mapping;
+        uint64_t length = 0;
+        if( const uint8_t* data = ma_vfs_mmap_view(&ma_vfs_mmap, path.get_data(), length, mapping) ) benchmark(nullptr, data, length, "memory");
+        
+        return results;
+    }
+    
     // click
     godot::Ref<rhythm::Track> get_click() const { return click; }
-    void set_click(const godot::Ref<rhythm::Audio>& p_click) { click = p_click; if(is_node_ready()) load_audio(click); }
+    void set_click(const godot::Ref<rhythm::Audio>& p_click) { click = p_click; if(is_node_ready() && click.is_valid()) load_click(); }
     
-    // click_latency
-    uint64_t get_click_latency() const { return click_latency; }
-    void set_click_latency(const uint64_t p_click_latency) { click_latency = p_click_latency; }
+    // play_click (only audible when true)
+    bool get_play_click() const { return metronome.enabled.load(std::memory_order_relaxed); }
+    void set_play_click(const bool p_play_click) { metronome.enabled.store(p_play_click, std::memory_order_relaxed); }
 
     int64_t get_current_track_length_in_frames() const
     {
         ma_uint64 ma_track_length_in_frames;
-        ma_sound_get_length_in_pcm_frames(current_track->sound, &ma_track_length_in_frames);
+        ma_sound_get_length_in_pcm_frames(sound_of(current_track), &ma_track_length_in_frames);
         
         return static_cast<int64_t>(ma_track_length_in_frames);
     }
@@ -345,22 +1494,23 @@ public:
     private:
     int64_t get_current_track_progress_in_frames() const
     {
-        if(!current_track.is_valid() || !current_track->loaded) return 0;
+        if(!current_track.is_valid() || !is_loaded(current_track)) return 0;
         
-        return (int64_t)ma_sound_get_time_in_pcm_frames(current_track->sound);
+        return (int64_t)ma_sound_get_time_in_pcm_frames(sound_of(current_track));
     }
     public:
     
     void set_current_track_progress_in_frames(int64_t frame)
     {
-        if(!current_track.is_valid() || !current_track->loaded) return;
+        if(!current_track.is_valid() || !is_loaded(current_track)) return;
 
+        finish_hot_swap(true);
+        
         frame = (frame > get_current_track_length_in_frames()) ? get_current_track_length_in_frames() : frame;
         
-        ma_sound_seek_to_pcm_frame(current_track->sound, (ma_uint64)frame);
+        ma_sound_seek_to_pcm_frame(sound_of(current_track), (ma_uint64)frame);
         conductor.seek(ma_engine_get_time_in_pcm_frames(&engine), frame); // again, this is a place where we are going off of the miniaudio read head for seeking .... (though it seems to work fine ?)
-        
-        next_click_index = conductor.next_beat_index;
+        metronome.publish(conductor);
     }
     
     double get_current_track_progress() const { return static_cast<double>(get_current_track_progress_in_frames()) / static_cast<double>(get_current_track_length_in_frames()); }
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <godot_cpp/classes/control.hpp>
+#include <godot_cpp/classes/font.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+
+#include "AudioMonitor.h"
+
+namespace rhythm
+{
+
+// draws an AudioMonitor in the corner of the screen: the load of every recent callback as a graph (100% is the
+// budget line), the counters, and how steadily the callbacks come (jitter). AudioEngine2 spawns one when
+// show_audio_overlay is on
+struct AudioMonitorOverlay : public godot::Control
+{
+    GDCLASS(AudioMonitorOverlay, Control)
+
+private:
+    static constexpr float width { 380.0f };
+    static constexpr float height { 176.0f };
+    static constexpr float graph_top { 80.0f };
+    static constexpr float max_load { 2.0f }; // (the top of the graph)
+
+public:
+    const AudioMonitor* monitor { nullptr };
+
+    void _ready() override
+    {
+        set_mouse_filter(MouseFilter::MOUSE_FILTER_IGNORE);
+        set_position({ 8, 8 });
+        set_size({ width, height });
+    }
+
+    void _process(double delta) override { queue_redraw(); }
+
+    void _draw() override
+    {
+        if( !monitor ) return;
+
+        draw_rect({ 0, 0, width, height }, { 0, 0, 0, 0.75 });
+
+        // load graph
+        const float graph_height = height - graph_top - 4.0f;
+        auto y_of = [&](float load) { return height - 4.0f - std::min(load, max_load) / max_load * graph_height; };
+
+        draw_line({ 0, y_of(1.0f) }, { width, y_of(1.0f) }, { 1, 0.3, 0.3, 0.8 }); // budget
+
+        godot::PackedVector2Array points;
+        float average = 0.0f, peak = 0.0f;
+        double average_jitter_ms = 0.0;
+        int64_t counted = 0, jitter_counted = 0;
+        float x = 0.0f;
+        const float x_step = width / AudioMonitor::history_size;
+        monitor->for_each([&](const AudioMonitor::Callback& callback)
+        {
+            x += x_step;
+            if( callback.frames == 0 ) return;
+
+            points.push_back({ x, y_of(callback.load) });
+            average += callback.load;
+            peak = std::max(peak, callback.load);
+            counted++;
+            if( callback.interval_ns > 0 )
+            {
+                average_jitter_ms += callback.jitter_ns / 1e6;
+                jitter_counted++;
+            }
+        });
+        if( counted ) average /= counted;
+        if( jitter_counted ) average_jitter_ms /= jitter_counted;
+
+        // (the share of callbacks that came within 10% of a period of when they should have)
+        uint64_t jitter_total = 0;
+        for( const auto& bucket : monitor->jitter_histogram ) jitter_total += bucket.load(std::memory_order_relaxed);
+        const double steady = jitter_total ? 100.0 * monitor->jitter_histogram[0].load(std::memory_order_relaxed) / jitter_total : 100.0;
+        if( points.size() > 1 ) draw_polyline(points, { 0.4, 1, 0.4, 1 }, 1.0f);
+
+        // counters
+        const godot::Ref<godot::Font> font = get_theme_default_font();
+        const int32_t font_size = 12;
+        const AudioMonitor::Callback& last = monitor->last;
+        const double budget_ms = monitor->budget_ns(last.frames) / 1e6;
+
+        draw_string(font, { 6, 16 }, "audio thread: " + godot::String::num_int64(last.frames) + " frames @ " + godot::String::num_int64(monitor->sample_rate) + " Hz, budget " + godot::String::num(budget_ms, 2) + " ms", godot::HORIZONTAL_ALIGNMENT_LEFT, -1, font_size);
+        draw_string(font, { 6, 32 }, "load: " + godot::String::num(average*100.0, 1) + "% average, " + godot::String::num(peak*100.0, 1) + "% peak, worst " + godot::String::num(monitor->worst_duration_ns.load(std::memory_order_relaxed) / 1e6, 2) + " ms", godot::HORIZONTAL_ALIGNMENT_LEFT, -1, font_size);
+        draw_string(font, { 6, 48 }, "overruns: " + godot::String::num_int64(monitor->overruns.load(std::memory_order_relaxed)) + ", late callbacks: " + godot::String::num_int64(monitor->late_callbacks.load(std::memory_order_relaxed)) + ", callbacks: " + godot::String::num_int64(monitor->callback_count.load(std::memory_order_relaxed)), godot::HORIZONTAL_ALIGNMENT_LEFT, -1, font_size);
+        draw_string(font, { 6, 64 }, "jitter: " + godot::String::num(average_jitter_ms, 2) + " ms average, worst " + godot::String::num(monitor->worst_jitter_ns.load(std::memory_order_relaxed) / 1e6, 2) + " ms, " + godot::String::num(steady, 1) + "% within 10% of a period", godot::HORIZONTAL_ALIGNMENT_LEFT, -1, font_size);
+    }
+
+protected:
+    static void _bind_methods() {}
+}; // AudioMonitorOverlay
+
+} // rhythm
@@ -54,7 +54,7 @@ public:
         
         if( audio_engine_2->current_track.is_valid() )
         {
-            audio_engine_2->decode_current_track(); // load entire track into memory so that scrubbing as no delay (otherwise conductor would fall out of time!)
+            audio_engine_2->decode_current_track(); // load entire track into memory (in the background) so that scrubbing has no delay (otherwise conductor would fall out of time!)
 
             proposed_beats = audio_engine_2->current_track->get_beats();
         }
@@ -90,7 +90,7 @@ public:
         click_checkbox->set_size({20, 20});
         click_checkbox->set_tooltip_text("whether or not to play a click sound when a beat happens");
         click_checkbox->set_focus_mode(Control::FOCUS_NONE);
-        click_checkbox->set_pressed(audio_engine_2->play_click);
+        click_checkbox->set_pressed(audio_engine_2->get_play_click());
         click_checkbox->connect("toggled", godot::Callable(this, "on_click_checkbox_changed"));
         add_child(click_checkbox);
     }
@@ -116,7 +116,7 @@ public:
                     }
                     else
                     {
-                        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine));
+                        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame();
                         audio_engine_2->set_current_track_progress_in_frames(local_current_frame + scroll_speed_in_frames);
                     }
 
@@ -133,7 +133,7 @@ public:
                     }
                     else
                     {
-                        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine));
+                        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame();
                         audio_engine_2->set_current_track_progress_in_frames(local_current_frame - scroll_speed_in_frames);
                     }
 
@@ -153,7 +153,7 @@ public:
             {
                 case godot::KEY_BACKSPACE:
                 {
-                    audio_engine_2->conductor.set_beats(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine), audio_engine_2->current_track->get_beats());
+                    audio_engine_2->set_conductor_beats(audio_engine_2->current_track->get_beats());
                     sm::SceneMachine* sm = sm::BXScene::get_machine(this);
                     if( sm ) sm->pop_scene();
                     break;
@@ -179,29 +179,29 @@ public:
                     if(audio_engine_2->conductor.next_beat_index >= 1)
                         proposed_beats = Track::delete_beat_at_index(proposed_beats, audio_engine_2->conductor.next_beat_index-1);
                     
-                    audio_engine_2->conductor.set_beats(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine), proposed_beats);
+                    audio_engine_2->set_conductor_beats(proposed_beats);
                     break;
                 }
                 case godot::KEY_M:
                 {
-                    int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine));
+                    int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame();
                     proposed_beats = Track::insert_beat_at_frame(proposed_beats, local_current_frame);
 
-                    audio_engine_2->conductor.set_beats(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine), proposed_beats);
+                    audio_engine_2->set_conductor_beats(proposed_beats);
                     
                     break;
                 }
                 case godot::KEY_COMMA:
                 {
                     proposed_beats = Track::nudge_beat_at_index(proposed_beats, audio_engine_2->conductor.next_beat_index-1, -nudge_speed_in_frames);
-                    audio_engine_2->conductor.set_beats(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine), proposed_beats);
+                    audio_engine_2->set_conductor_beats(proposed_beats);
 
                     break;
                 }
                 case godot::KEY_PERIOD:
                 {
                     proposed_beats = Track::nudge_beat_at_index(proposed_beats, audio_engine_2->conductor.next_beat_index-1, nudge_speed_in_frames);
-                    audio_engine_2->conductor.set_beats(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine), proposed_beats);
+                    audio_engine_2->set_conductor_beats(proposed_beats);
 
                     break;
                 }
@@ -213,7 +213,7 @@ public:
     
     void _process(double delta) override
     {
-        position_slider->set_value_no_signal(audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine)));
+        position_slider->set_value_no_signal(audio_engine_2->conductor.get_local_current_frame());
         queue_redraw();
     }
     
@@ -231,7 +231,7 @@ public:
         // find current global and local frames, as well as current pitch 
         const float pitch = audio_engine_2->get_current_track_pitch();
         const rhythm::Conductor& conductor = audio_engine_2->conductor;
-        int64_t global_current_frame = ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine);
+        int64_t global_current_frame = conductor.get_global_current_frame();
         int64_t local_current_frame  = conductor.get_local_current_frame(global_current_frame);
         
         // draw frame-axis (x-axis)
@@ -276,6 +276,10 @@ public:
             else draw_line({(float)beat_x, h/2 - beat_line_height }, {(float)beat_x, h/2 + beat_line_height }, beats_color, 1.5);
 
         }
+        
+        // draw decode progress (the track is still streaming until this fills up)
+        const float decode_progress = audio_engine_2->get_decode_progress();
+        if( decode_progress >= 0 ) draw_rect({ 0, 0, w*decode_progress, 4 }, beats_color);
     }
 
     void on_pitch_slider_changed(double p_value)
@@ -290,7 +294,7 @@ public:
 
     void on_click_checkbox_changed(bool p_toggle_mode)
     {
-        audio_engine_2->play_click = p_toggle_mode;
+        audio_engine_2->set_play_click(p_toggle_mode);
     }
 
 protected:
@@ -158,7 +158,7 @@ public:
         if( abs(mouse_hover_stave) > 4 ) mouse_hover_stave = 0;
         
         // calculate which beat the mouse is hovering over
-        const int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine)); // this is the frame of now_line
+        const int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(); // this is the frame of now_line
         const int64_t local_mouse_hover_dframes = x_to_frame(mouse_center_x_dist);
         const int64_t local_mouse_hover_frame = local_current_frame + local_mouse_hover_dframes; // this then is the frame the mouse is hovered over
         mouse_hover_beat = audio_engine_2->conductor.next_beat_search(local_mouse_hover_frame) - 1;
@@ -260,7 +260,7 @@ public:
         draw_line({ 0, stave_Ltop }, { w, stave_Ltop }, { 1, 1, 1, 1 }, lw);
         
         // draw beats
-        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame(ma_engine_get_time_in_pcm_frames(&audio_engine_2->engine));
+        int64_t local_current_frame = audio_engine_2->conductor.get_local_current_frame();
         const int64_t* beats_ptr = beats.ptr();
         for(int i = 0; i < beats.size(); i++)
         {
@@ -381,6 +381,10 @@ public:
         // draw beat : position text
         if( mouse_hover_stave != mouse_hover_stave_none )
             draw_string(get_theme_default_font(), mouse_pos, godot::String::num_int64(mouse_hover_beat) + " : " + godot::String::num_real(mouse_hover_position));
+        
+        // draw decode progress (the track is still streaming until this fills up)
+        const float decode_progress = audio_engine_2->get_decode_progress();
+        if( decode_progress >= 0 ) draw_rect({ 0, 0, w*decode_progress, 4 }, { 1, 1, 1, 0.5 });
     }
 
 protected:
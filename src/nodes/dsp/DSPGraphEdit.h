@@ -1,12 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include <godot_cpp/classes/control.hpp>
 #include <godot_cpp/classes/input_event_key.hpp>
 #include <godot_cpp/classes/graph_edit.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 
 #include "nodes/sm/SceneMachine.h"
 
 #include "ma_dsp_godot.h"
+#include "dsp/plan.h"
+#include "Filter.h"
 #include "Multiplier.h"
 #include "Oscillator.h"
 #include "Output.h"
@@ -24,8 +31,15 @@ private:
     
     // dont really like this, and once we are saving patches this should def change / will probably have to change
     std::vector<dsp::DSPNode*> dsp_nodes;
+    
+    // every connection, compiled into a plan for plan_node to run whenever they change
+    std::vector<dsp::Edge> edges;
+    dsp::plan_node plan_node;
+    ma_uint32 channels { 2 };
+    
     ~DSPGraphEdit()
     {
+        plan_node.uninit(); // (before the nodes the plan points to are gone. does nothing after _exit_tree)
         for( const DSPNode* node : dsp_nodes ) delete node;
     }
 
@@ -39,6 +53,7 @@ public:
 
         connect("connection_request", callable_mp(this, &DSPGraphEdit::on_connection_request));
         connect("disconnection_request", callable_mp(this, &DSPGraphEdit::on_disconnection_request));
+        connect("delete_nodes_request", callable_mp(this, &DSPGraphEdit::on_delete_nodes_request));
         
         ma_engine& engine = BXCTX::get().audio_engine_2->engine;
         
@@ -53,13 +68,33 @@ public:
         oscillator_button->set_text("add oscillator");
         oscillator_button->connect("pressed", callable_mp(this, &DSPGraphEdit::spawn_oscillator));
         hboxcontainer->add_child(oscillator_button);
+
+        godot::Button* filter_button = memnew(godot::Button);
+        filter_button->set_text("add filter");
+        filter_button->connect("pressed", callable_mp(this, &DSPGraphEdit::spawn_filter));
+        hboxcontainer->add_child(filter_button);
         
         output_node.init(&engine);
+        channels = ma_engine_get_channels(&engine);
+        ma_result result = plan_node.init(&engine);
+        if( result != MA_SUCCESS ) godot::print_error("[DSPGraphEdit::_ready] couldn't init plan_node, error: " + godot::String(ma_result_description(result)));
+        
         output_graph_node = memnew(rhythm::dsp::OutputGraphNode);
         output_graph_node->set_dsp_node(&output_node);
         add_child(output_graph_node);
     }
 
+    void _process(double delta) override
+    {
+        plan_node.collect();
+    }
+    
+    // (while the engine is still around, see AudioEngine2::_exit_tree)
+    void _exit_tree() override
+    {
+        plan_node.uninit();
+    }
+
     void _input(const godot::Ref<godot::InputEvent>& event) override
     {
         godot::Ref<godot::InputEventKey> key_event = event;
@@ -90,58 +125,106 @@ public:
         }
     }
     
-    ma_node* get_ma_node(const godot::StringName& node_name)
+    dsp::DSPNode* get_dsp_node(const godot::StringName& node_name)
     {
         godot::Node* node = get_node_or_null(godot::NodePath(node_name));
         if( !node )
         {
-            godot::print_error("[DSPGraphEdit::get_ma_node] node '" + node_name + "' is null!");
+            godot::print_error("[DSPGraphEdit::get_dsp_node] node '" + node_name + "' is null!");
             return nullptr;
         }
         
         dsp::DSPGraphNode* graph_node = godot::Object::cast_to<rhythm::dsp::DSPGraphNode>(node);
         if( !graph_node )
         {
-            godot::print_error("[DSPGraphEdit::get_ma_node] node '" + node_name + "' is not a rhythm::dsp::DSPGraphEditNode!");
+            godot::print_error("[DSPGraphEdit::get_dsp_node] node '" + node_name + "' is not a rhythm::dsp::DSPGraphEditNode!");
             return nullptr;
         }
         
         dsp::DSPNode* dsp_node = graph_node->get_dsp_node();
         if( !dsp_node )
         {
-            godot::print_error("[DSPGraphEdit::get_ma_node] node '" + node_name + "' is a rhythm::dsp::DSPGraphEditNode, but has no rhythm::dsp::DSPNode dsp_node!");
+            godot::print_error("[DSPGraphEdit::get_dsp_node] node '" + node_name + "' is a rhythm::dsp::DSPGraphEditNode, but has no rhythm::dsp::DSPNode dsp_node!");
             return nullptr;
         }
         
-        ma_node* ma_node = dsp_node->get_ma_node();
-        if( !ma_node )
-        {
-            godot::print_error("[DSPGraphEdit::get_ma_node] node '" + node_name + "' has a rhythm::dsp::DSPNode dsp_node, but dsp_node has no ma_node!");
-            return nullptr;
-        }
+        return dsp_node;
+    }
+    
+    // compiles edges and hands the plan to the audio thread. false (and nothing published) if they have a cycle
+    bool recompile()
+    {
+        std::unique_ptr<dsp::Plan> plan = dsp::Plan::compile(edges, &output_node, channels);
+        if( !plan ) return false;
         
-        return ma_node;
+        plan_node.publish(std::move(plan));
+        return true;
     }
     
     void on_connection_request(const godot::StringName& from_node, int from_port, const godot::StringName& to_node, int to_port)
     {
-        ma_node* source = get_ma_node(from_node);
-        ma_node* dest   = get_ma_node(to_node);
+        dsp::DSPNode* source = get_dsp_node(from_node);
+        dsp::DSPNode* dest   = get_dsp_node(to_node);
+        if( !source || !dest ) return;
         
-        if( source && dest )
+        const dsp::Edge edge { source, static_cast<uint32_t>(from_port), dest, static_cast<uint32_t>(to_port) };
+        if( std::find(edges.begin(), edges.end(), edge) != edges.end() ) return;
+        
+        edges.push_back(edge);
+        if( !recompile() )
         {
-            ma_node_attach_output_bus(source, from_port, dest, to_port);
-            connect_node(from_node, from_port, to_node, to_port);
+            edges.pop_back();
+            godot::print_error("[DSPGraphEdit::on_connection_request] connecting '" + from_node + "' to '" + to_node + "' would make a cycle!");
+            return;
         }
+        
+        connect_node(from_node, from_port, to_node, to_port);
     }
     void on_disconnection_request(const godot::StringName& from_node, int from_port, const godot::StringName& to_node, int to_port)
     {
-        ma_node* source = get_ma_node(from_node);
-
-        if( source )
+        dsp::DSPNode* source = get_dsp_node(from_node);
+        dsp::DSPNode* dest   = get_dsp_node(to_node);
+        
+        if( source && dest )
         {
-            ma_node_detach_output_bus(source, from_port);
-            disconnect_node(from_node, from_port, to_node, to_port);
+            const dsp::Edge edge { source, static_cast<uint32_t>(from_port), dest, static_cast<uint32_t>(to_port) };
+            edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+            recompile();
+        }
+        
+        disconnect_node(from_node, from_port, to_node, to_port);
+    }
+    
+    // the dsp nodes are only deleted once the audio thread has moved on to a plan without them (see plan_node::retire)
+    void on_delete_nodes_request(const godot::TypedArray<godot::StringName>& nodes)
+    {
+        for( int64_t i = 0; i < nodes.size(); i++ )
+        {
+            const godot::StringName node_name = nodes[i];
+            if( output_graph_node && node_name == output_graph_node->get_name() ) continue;
+            
+            godot::Node* node = get_node_or_null(godot::NodePath(node_name));
+            dsp::DSPGraphNode* graph_node = godot::Object::cast_to<rhythm::dsp::DSPGraphNode>(node);
+            if( !graph_node ) continue;
+            
+            const godot::TypedArray<godot::Dictionary> connections = get_connection_list();
+            for( int64_t c = 0; c < connections.size(); c++ )
+            {
+                const godot::Dictionary connection = connections[c];
+                if( godot::StringName(connection["from_node"]) == node_name || godot::StringName(connection["to_node"]) == node_name )
+                    disconnect_node(connection["from_node"], connection["from_port"], connection["to_node"], connection["to_port"]);
+            }
+            
+            dsp::DSPNode* dsp_node = graph_node->get_dsp_node();
+            graph_node->set_dsp_node(nullptr); // (it still gets a _process before it's freed)
+            graph_node->queue_free();
+            if( !dsp_node ) continue;
+            
+            edges.erase(std::remove_if(edges.begin(), edges.end(), [dsp_node](const dsp::Edge& edge) { return edge.from == dsp_node || edge.to == dsp_node; }), edges.end());
+            dsp_nodes.erase(std::remove(dsp_nodes.begin(), dsp_nodes.end(), dsp_node), dsp_nodes.end());
+            
+            recompile();
+            plan_node.retire(dsp_node);
         }
     }
     
@@ -158,6 +241,7 @@ public:
         // create corresponding dsp graph node
         DSPGraphEditNodeType* graph_node = memnew(DSPGraphEditNodeType);
         graph_node->set_dsp_node(node);
+        graph_node->set_commands(&plan_node);
         graph_node->set_position_offset(get_scroll_offset() + 0.5*get_size());
         add_child(graph_node);
     }
@@ -165,12 +249,14 @@ public:
     // non-template wrapper functions to be called by godot
     void spawn_multiplier() { spawn_node<MultiplierNode, MultiplierGraphNode>(); }
     void spawn_oscillator() { spawn_node<OscillatorNode, OscillatorGraphNode>(); }
+    void spawn_filter() { spawn_node<FilterNode, FilterGraphNode>(); }
 
 protected:
     static void _bind_methods()
     {
         godot::ClassDB::bind_method(godot::D_METHOD("on_connection_request", "from_node", "from_port", "to_node", "to_port"), &DSPGraphEdit::on_connection_request);
         godot::ClassDB::bind_method(godot::D_METHOD("on_disconnection_request", "from_node", "from_port", "to_node", "to_port"), &DSPGraphEdit::on_disconnection_request);
+        godot::ClassDB::bind_method(godot::D_METHOD("on_delete_nodes_request", "nodes"), &DSPGraphEdit::on_delete_nodes_request);
     }
 }; // DSPGraphEdit
 
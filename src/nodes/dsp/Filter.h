@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ma_dsp_godot.h"
+#include "dsp/filter_node.h"
+
+#include <godot_cpp/classes/label.hpp>
+#include <godot_cpp/classes/h_slider.hpp>
+#include <godot_cpp/classes/h_box_container.hpp>
+#include <godot_cpp/classes/option_button.hpp>
+
+namespace rhythm::dsp
+{
+
+struct FilterGraphNode : public DSPGraphNode
+{
+    GDCLASS(FilterGraphNode, DSPGraphNode)
+
+private:
+    godot::OptionButton* type_option_button { nullptr };
+    godot::HSlider* cutoff_slider { nullptr };
+    godot::Label* cutoff_label { nullptr };
+    godot::HSlider* q_slider { nullptr };
+    godot::Label* q_label { nullptr };
+    godot::HSlider* gain_slider { nullptr };
+    godot::Label* gain_label { nullptr };
+    godot::HSlider* stages_slider { nullptr };
+    godot::Label* stages_label { nullptr };
+
+    // a slider and a label showing its value, in a row
+    godot::HSlider* add_slider_row(double min, double max, double step, bool exp_ratio, godot::Label*& label)
+    {
+        godot::HBoxContainer* hboxcontainer = memnew(godot::HBoxContainer);
+
+        godot::HSlider* slider = memnew(godot::HSlider);
+        slider->set_h_size_flags(godot::Control::SIZE_EXPAND_FILL);
+        slider->set_custom_minimum_size({60, 0});
+        slider->set_min(min);
+        slider->set_max(max);
+        slider->set_step(step);
+        slider->set_exp_ratio(exp_ratio);
+        hboxcontainer->add_child(slider);
+
+        label = memnew(godot::Label);
+        hboxcontainer->add_child(label);
+
+        add_child(hboxcontainer);
+        return slider;
+    }
+
+public:
+    void _ready() override
+    {
+        set_title("filter");
+
+        set_slot(0, true, 0, dsp::in_color, true, 0, dsp::out_color);
+        type_option_button = memnew(godot::OptionButton);
+        for( int32_t type = (int32_t)bqcfg::Type::lpf2; type <= (int32_t)bqcfg::Type::hishelf2; type++ )
+            type_option_button->add_item(bqcfg::type_to_string((bqcfg::Type)type), type);
+        type_option_button->connect("item_selected", callable_mp(this, &FilterGraphNode::type_option_button_item_selected));
+        add_child(type_option_button);
+
+        cutoff_slider = add_slider_row(20.0, 20000.0, 1.0, true, cutoff_label);
+        cutoff_slider->connect("value_changed", callable_mp(this, &FilterGraphNode::cutoff_slider_value_changed));
+
+        q_slider = add_slider_row(0.1, 20.0, 0.01, true, q_label);
+        q_slider->connect("value_changed", callable_mp(this, &FilterGraphNode::q_slider_value_changed));
+
+        gain_slider = add_slider_row(-24.0, 24.0, 0.1, false, gain_label);
+        gain_slider->connect("value_changed", callable_mp(this, &FilterGraphNode::gain_slider_value_changed));
+
+        stages_slider = add_slider_row(1, biquad_cascade::max_stages, 1, false, stages_label);
+        stages_slider->connect("value_changed", callable_mp(this, &FilterGraphNode::stages_slider_value_changed));
+    }
+
+    void _process(double delta) override
+    {
+        if( !dsp_node ) return;
+
+        FilterNode* filter = (FilterNode*)dsp_node;
+        filter->collect();
+
+        type_option_button->select(type_option_button->get_item_index((int32_t)filter->type));
+
+        cutoff_slider->set_value_no_signal(filter->cutoff);
+        cutoff_label->set_text(godot::String::num(filter->cutoff, 0) + " Hz");
+
+        const bool shelf = ( filter->type == bqcfg::Type::loshelf2 || filter->type == bqcfg::Type::hishelf2 );
+        q_slider->set_value_no_signal(filter->q);
+        q_label->set_text(godot::String(shelf ? "slope " : "q ") + godot::String::num(filter->q, 2));
+
+        gain_slider->set_value_no_signal(filter->gain_db);
+        gain_label->set_text(godot::String::num(filter->gain_db, 1) + " dB");
+
+        stages_slider->set_value_no_signal(filter->stages);
+        stages_label->set_text("x" + godot::String::num_int64(filter->stages));
+    }
+
+    void type_option_button_item_selected(int index)
+    {
+        if( !dsp_node ) return;
+        ((FilterNode*)dsp_node)->set_type(type_option_button->get_item_id(index));
+    }
+
+    void cutoff_slider_value_changed(double value)
+    {
+        if( !dsp_node ) return;
+        ((FilterNode*)dsp_node)->set_cutoff(value);
+    }
+
+    void q_slider_value_changed(double value)
+    {
+        if( !dsp_node ) return;
+        ((FilterNode*)dsp_node)->set_q(value);
+    }
+
+    void gain_slider_value_changed(double value)
+    {
+        if( !dsp_node ) return;
+        ((FilterNode*)dsp_node)->set_gain_db(value);
+    }
+
+    void stages_slider_value_changed(double value)
+    {
+        if( !dsp_node ) return;
+        ((FilterNode*)dsp_node)->set_stages(static_cast<int>(value));
+    }
+
+protected:
+    static void _bind_methods() {}
+}; // FilterGraphNode
+
+} // rhythm::dsp
@@ -1,26 +1,13 @@
 #pragma once
 
 #include "ma_dsp_godot.h"
+#include "dsp/output_node.h"
 
 #include <godot_cpp/classes/label.hpp>
 
 namespace rhythm::dsp
 {
 
-struct OutputNode : public DSPNode
-{
-    ma_node* endpoint = nullptr;
-    
-    ma_result init(ma_engine* p_engine) override
-    {
-        endpoint = (ma_node*)ma_engine_get_endpoint(p_engine);
-        
-        return MA_SUCCESS;
-    }
-    
-    ma_node* get_ma_node() override { return endpoint; }
-}; // OutputNode
-
 struct OutputGraphNode : public DSPGraphNode
 {
     GDCLASS(OutputGraphNode, DSPGraphNode)
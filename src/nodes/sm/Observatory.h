@@ -51,6 +51,8 @@ struct Observatory : public sm::BXScene
     
     godot::Ref<rhythm::Constellation> current_constellation;
     int selected_track_index { 0 };
+    // how many tracks either side of the selected one to keep loaded, so that switching to them is instant
+    int prefetch_radius { 2 };
     godot::RichTextLabel* selected_track_label;
 
 public:
@@ -140,6 +142,7 @@ public:
 
             audio_engine_2->set_current_track(current_constellation->tracks[selected_track_index]);
             audio_engine_2->play_current_track();
+            prefetch_neighbors();
         }
         else godot::print_error("[Observatory::current_constellation] no constellation set! ignoring ...");
     }
@@ -158,8 +161,8 @@ public:
 
                     move_to( MULTIPLY_BY_G(G, current_constellation->ids[selected_track_index] ));
                     
-                    audio_engine_2->set_current_track(current_constellation->tracks[selected_track_index]);
-                    audio_engine_2->play_current_track();
+                    audio_engine_2->crossfade_to(current_constellation->tracks[selected_track_index]);
+                    prefetch_neighbors();
 
                     break;
                 }
@@ -170,8 +173,8 @@ public:
 
                     move_to( MULTIPLY_BY_G(G, current_constellation->ids[selected_track_index] ));
 
-                    audio_engine_2->set_current_track(current_constellation->tracks[selected_track_index]);
-                    audio_engine_2->play_current_track();
+                    audio_engine_2->crossfade_to(current_constellation->tracks[selected_track_index]);
+                    prefetch_neighbors();
 
                     break;
                 }
@@ -288,6 +291,20 @@ public:
     }
     
     
+    /*
+        each Track in the lattice only connects to the next one, so the tracks adjacent to the selected one are
+        simply the ones either side of it (which is also where KEY_UP and KEY_DOWN go)
+    */
+    void prefetch_neighbors()
+    {
+        const int size = current_constellation->get_tracks().size();
+        for( int d = 1; d <= prefetch_radius && d < size; d++ )
+        {
+            audio_engine_2->prefetch(current_constellation->tracks[ (selected_track_index+d) % size ]);
+            audio_engine_2->prefetch(current_constellation->tracks[ (selected_track_index-d + size) % size ]);
+        }
+    }
+    
     /*
         focuses the Observatory to the given point, in std basis
     */
@@ -460,6 +477,9 @@ public:
     godot::Ref<godot::ShaderMaterial> get_adjacency_shader_material() const { return adjacency_shader_material; }
     void set_adjacency_shader_material(const godot::Ref<godot::ShaderMaterial>& p_adjacency_shader_material) { adjacency_shader_material = p_adjacency_shader_material; }
     
+    int get_prefetch_radius() const { return prefetch_radius; }
+    void set_prefetch_radius(const int p_prefetch_radius) { prefetch_radius = p_prefetch_radius; }
+    
     godot::Ref<rhythm::Constellation> get_current_constellation() const { return current_constellation; }
     void set_current_constellation(const godot::Ref<rhythm::Constellation>& p_current_constellation) { current_constellation = p_current_constellation; current_constellation->cache(); }
 
@@ -477,6 +497,10 @@ protected:
         godot::ClassDB::bind_method(godot::D_METHOD("get_current_constellation"), &rhythm::sm::Observatory::get_current_constellation);
         godot::ClassDB::bind_method(godot::D_METHOD("set_current_constellation", "p_track"), &rhythm::sm::Observatory::set_current_constellation);
         ADD_PROPERTY(godot::PropertyInfo(godot::Variant::OBJECT, "current_constellation", godot::PROPERTY_HINT_RESOURCE_TYPE, "Constellation"), "set_current_constellation", "get_current_constellation");
+
+        godot::ClassDB::bind_method(godot::D_METHOD("get_prefetch_radius"), &rhythm::sm::Observatory::get_prefetch_radius);
+        godot::ClassDB::bind_method(godot::D_METHOD("set_prefetch_radius", "p_prefetch_radius"), &rhythm::sm::Observatory::set_prefetch_radius);
+        ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "prefetch_radius"), "set_prefetch_radius", "get_prefetch_radius");
     }
 
 }; // Observatory
@@ -10,6 +10,7 @@
 /* godot::Node !*/
 #include "AudioEngine2.h"
 #include "AudioEngine2_Pause_Shader.h"
+#include "AudioMonitorOverlay.h"
 #include "BeatEditor.h"
 #include "BXApi.h"
 #include "LoginWindow.h"
@@ -18,6 +19,7 @@
 /* DSP ( digital signal processing! ) */
 #include "nodes/dsp/DSPGraphEdit.h"
 #include "nodes/dsp/DSPGraphEditor.h"
+#include "nodes/dsp/Filter.h"
 #include "nodes/dsp/Multiplier.h"
 #include "nodes/dsp/Oscillator.h"
 #include "nodes/dsp/Output.h"
@@ -43,6 +45,7 @@ void inline register_nodes()
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::DSPGraphEdit);
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::DSPGraphEditor);
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::DSPGraphNode);
+    GDREGISTER_RUNTIME_CLASS(rhythm::dsp::FilterGraphNode);
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::MultiplierGraphNode);
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::OscillatorGraphNode);
     GDREGISTER_RUNTIME_CLASS(rhythm::dsp::OutputGraphNode);
@@ -58,6 +61,7 @@ void inline register_nodes()
     /* godot::Node */
     GDREGISTER_RUNTIME_CLASS(rhythm::AudioEngine2);
     GDREGISTER_RUNTIME_CLASS(rhythm::AudioEngine2_Pause_Shader);
+    GDREGISTER_RUNTIME_CLASS(rhythm::AudioMonitorOverlay);
     GDREGISTER_RUNTIME_CLASS(rhythm::BeatEditor);
     GDREGISTER_RUNTIME_CLASS(rhythm::BXApi);
     GDREGISTER_RUNTIME_CLASS(rhythm::LoginWindow);
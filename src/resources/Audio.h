@@ -1,6 +1,7 @@
 #pragma once
 
 #include "miniaudio.h"
+#include "SoundPool.h"
 
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/core/class_db.hpp>
@@ -13,13 +14,10 @@ class Audio : public godot::Resource
     GDCLASS(Audio, Resource);
 
 public:
-    // these should probably(?) be private, however it makes it much easier to load a Track if AudioEngine can directly modify it
-    ma_sound* sound;
-
-    // both of these are set on AudioEngine::load_audio
-    int AudioEngine2_sounds_index { -1 };
-    bool loaded { false }; // whether or not miniaudio has loaded this audio as an ma_sound
-    bool decoded { false }; // whether or not miniaudio FULLY loaded (MA_SOUND_FLAG_DECODE) this audio as an ma_sound (see AudioEngine2::decode_current_track)
+    // this should probably(?) be private, however it makes it much easier to load a Track if AudioEngine can directly modify it
+    // set on AudioEngine2::load_audio. whether it's loaded (or fully decoded) is up to AudioEngine2's SoundPool, since
+    // the sound can be unloaded from under us at any time (see SoundPool.h)
+    SoundHandle sound_handle;
 private:
     godot::StringName file_path;
 
@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+"""
+packs every audio file in rhythm-game/audio into rhythm-game/audio.bxaa, which AudioEngine2 mounts at startup
+(see src/AudioArchive.h for the layout)
+
+usage: python tools/pack_audio.py [audio dir] [archive]
+
+paths in the archive are relative to the godot project (the parent of the audio dir), so
+res://audio/click.wav is stored as audio/click.wav
+"""
+
+import os
+import struct
+import sys
+
+MAGIC = b"BXAA"
+VERSION = 1
+ALIGNMENT = 4096
+
+HEADER_SIZE = 64
+ENTRY_SIZE = 24
+
+# godot's sidecar files, which aren't audio
+IGNORED_EXTENSIONS = { ".import", ".asd", ".uid" }
+
+
+def align(offset):
+    return (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def collect(audio_dir):
+    project_dir = os.path.dirname(os.path.abspath(audio_dir))
+
+    files = []
+    for root, _, names in os.walk(audio_dir):
+        for name in names:
+            if os.path.splitext(name)[1] in IGNORED_EXTENSIONS: continue
+
+            full_path = os.path.join(root, name)
+            archive_path = os.path.relpath(full_path, project_dir).replace(os.sep, "/")
+            files.append((archive_path.encode("utf-8"), full_path))
+
+    # sorted bytewise, since that's how AudioArchive::find() searches
+    files.sort(key=lambda f: f[0])
+    return files
+
+
+def pack(audio_dir, archive_path):
+    files = collect(audio_dir)
+
+    strings = b"".join(path for path, _ in files)
+    strings_offset = HEADER_SIZE + len(files)*ENTRY_SIZE
+
+    entries = []
+    path_offset = 0
+    data_offset = align(strings_offset + len(strings))
+    for path, full_path in files:
+        length = os.path.getsize(full_path)
+        entries.append(struct.pack("<QQII", data_offset, length, path_offset, len(path)))
+
+        path_offset += len(path)
+        data_offset = align(data_offset + length)
+
+    header = struct.pack("<4sIIIQQ32x", MAGIC, VERSION, len(files), ALIGNMENT, strings_offset, len(strings))
+
+    # write to a temporary first, so that a half-written archive is never mounted
+    temporary_path = archive_path + ".tmp"
+    with open(temporary_path, "wb") as archive:
+        archive.write(header)
+        archive.write(b"".join(entries))
+        archive.write(strings)
+
+        for (path, full_path), entry in zip(files, entries):
+            offset = struct.unpack("<QQII", entry)[0]
+            archive.write(b"\0" * (offset - archive.tell()))
+            with open(full_path, "rb") as f: archive.write(f.read())
+
+            print("  {} ({} bytes)".format(path.decode("utf-8"), os.path.getsize(full_path)))
+
+    os.replace(temporary_path, archive_path)
+    print("packed {} files into {} ({} bytes)".format(len(files), archive_path, os.path.getsize(archive_path)))
+
+
+if __name__ == "__main__":
+    repo_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+    audio_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(repo_dir, "rhythm-game", "audio")
+    archive_path = sys.argv[2] if len(sys.argv) > 2 else os.path.join(os.path.dirname(os.path.abspath(audio_dir)), "audio.bxaa")
+
+    pack(audio_dir, archive_path)